@@ -0,0 +1,380 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <boost/program_options.hpp>
+#include <kcudf/kcudf.hh>
+#include <kcudf/swriter.hh>
+#include <kcudf/gwriter.hh>
+#include <kcudf/reduce.hh>
+#include <bench/generator.hh>
+#include <tools/alloc-counter.hh>
+
+using namespace boost::program_options;
+
+/**
+ * \brief Peak resident set size of the process in kilobytes.
+ *
+ * Every run is done in its own process (see \a main), so this is the peak of
+ * the current run.
+ */
+static long peakRSS(void) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;
+}
+
+/// Size of file \a fname in bytes
+static unsigned long long fileSize(const std::string& fname) {
+  std::ifstream is(fname.c_str(), std::ios::binary | std::ios::ate);
+  return is ? static_cast<unsigned long long>(is.tellg()) : 0;
+}
+
+/**
+ * \brief Writer that only counts the records it receives.
+ */
+class CountingWriter final : public KCudfWriter {
+public:
+  /// Number of records
+  unsigned long long records;
+  CountingWriter(void) : records(0) {}
+  void package(unsigned int, bool, bool, const char*) { records++; }
+  void dependency(unsigned int, unsigned int, const char*) { records++; }
+  void conflict(unsigned int, unsigned int, const char*) { records++; }
+  void provides(unsigned int, unsigned int, const char*) { records++; }
+  void atMostOne(const std::vector<unsigned int>&, const char*) { records++; }
+};
+
+/**
+ * \brief Measure of one phase of the pipeline.
+ */
+class Phase {
+private:
+  typedef std::chrono::steady_clock clock;
+  /// Start time
+  clock::time_point start;
+  /// Allocations at the start
+  unsigned long long allocs;
+public:
+  /// Name of the phase
+  std::string name;
+  /// Elapsed seconds
+  double secs;
+  /// Allocations done by the phase
+  unsigned long long nallocs;
+  /// Items processed by the phase
+  unsigned long long items;
+  /// Unit of the items
+  std::string unit;
+  /// Bytes read or written by the phase (0 if not meaningful)
+  unsigned long long bytes;
+  /// Peak resident set size (KB) of the run up to the end of the phase
+  long rss;
+  /// Starts measuring phase \a n
+  Phase(const char* n)
+    : start(clock::now()), allocs(allocations()), name(n), secs(0), nallocs(0),
+      items(0), unit(), bytes(0), rss(0) {}
+  /// Stops measuring, \a i items of unit \a u were processed
+  void stop(unsigned long long i, const char* u, unsigned long long b = 0) {
+    secs = std::chrono::duration<double>(clock::now() - start).count();
+    nallocs = allocations() - allocs;
+    items = i; unit = u; bytes = b;
+    rss = peakRSS();
+  }
+};
+
+/// Output the measures of phase \a p
+std::ostream& operator<< (std::ostream& os, const Phase& p) {
+  std::ios::fmtflags f = os.flags();
+  std::ostringstream thr;
+  thr << std::fixed << std::setprecision(0)
+      << (p.secs > 0 ? p.items / p.secs : 0) << " " << p.unit << "/s";
+  if (p.bytes > 0 && p.secs > 0)
+    thr << ", " << std::setprecision(1) << p.bytes / p.secs / 1048576.0 << " MB/s";
+  os << std::left << std::setw(12) << p.name << std::right
+     << std::fixed << std::setprecision(4) << std::setw(10) << p.secs
+     << std::setw(12) << p.items << " " << std::left << std::setw(9) << p.unit
+     << std::setw(36) << thr.str() << std::right
+     << std::setw(12) << p.nallocs << std::setw(12) << p.rss;
+  os.flags(f);
+  return os;
+}
+
+/**
+ * \brief Runs the whole pipeline on the universe described by \a up. All the
+ * files are created with prefix \a pfx. The reduction is run once with every
+ * scheduling policy in \a pols.
+ */
+static void run(const UniverseParams& up, const std::string& pfx,
+                const std::vector<WL_POLICY>& pols, std::ostream& out) {
+  const std::string cudf = pfx + ".cudf", kcudf = pfx + ".kcudf",
+    info = pfx + ".info", solved = pfx + ".solved", search = pfx + ".search";
+  std::vector<Phase> phases;
+  out << "# universe: " << up << std::endl;
+
+  // generation
+  Phase gen("generate");
+  unsigned int npkgs;
+  {
+    std::ofstream os(cudf.c_str());
+    npkgs = generate(os, up);
+  }
+  gen.stop(npkgs, "pkgs", fileSize(cudf));
+  phases.push_back(gen);
+
+  // cudf parsing
+  Phase prs("parse");
+  CudfDoc doc;
+  {
+    std::ifstream is(cudf.c_str());
+    parse(is, doc);
+  }
+  prs.stop(npkgs, "pkgs", fileSize(cudf));
+  phases.push_back(prs);
+
+  // KCudfData construction (inside the translator)
+  Phase dt("kcudfdata");
+  std::unique_ptr<KCudfTranslator> tr;
+  try {
+    tr.reset(new KCudfTranslator(doc));
+  } catch (KCudfFailure& f) {
+    out << "# translation failed: " << f.what() << std::endl;
+    return;
+  }
+  dt.stop(npkgs, "pkgs");
+  phases.push_back(dt);
+
+  // translation
+  Phase ts("translate");
+  {
+    KCudfFileWriter kw(kcudf.c_str());
+    KCudfInfoFileWriter iw(info.c_str());
+    tr->translate(kw, iw);
+  }
+  tr.reset();
+  ts.stop(npkgs, "pkgs", fileSize(kcudf) + fileSize(info));
+  phases.push_back(ts);
+
+  // kcudf reading
+  Phase rd("read");
+  unsigned long long records;
+  {
+    CountingWriter cw;
+    std::ifstream is(kcudf.c_str());
+    read(is, cw);
+    records = cw.records;
+  }
+  rd.stop(records, "records", fileSize(kcudf));
+  phases.push_back(rd);
+
+  // graph ingestion (including reading)
+  Phase gw("graph");
+  {
+    GraphWriter g;
+    std::ifstream is(kcudf.c_str());
+    read(is, g);
+  }
+  gw.stop(records, "records", fileSize(kcudf));
+  phases.push_back(gw);
+
+  // reduction (reading the input is not measured), once per policy
+  KCudfReducer::RD_OUT r = KCudfReducer::RDO_FAIL;
+  unsigned int srch = 0;
+  std::vector<unsigned long> tasks;
+  for (WL_POLICY pol : pols) {
+    KCudfReducer red;
+    red.scheduling(pol);
+    {
+      std::ifstream is(kcudf.c_str());
+      read(is, red);
+    }
+    std::string name("reduce");
+    if (pols.size() > 1)
+      name.append("-").append(policyName(pol));
+    Phase rc(name.c_str());
+    {
+      KCudfFileWriter es(solved.c_str());
+      KCudfFileWriter sr(search.c_str());
+      r = red.reduce(es, sr);
+    }
+    rc.stop(red.numPackages(), "pkgs", fileSize(solved) + fileSize(search));
+    phases.push_back(rc);
+    srch = red.stats().pkg_srch;
+    tasks.push_back(red.stats().tasks);
+  }
+
+  // update of the document with the reduced problem
+  Phase ud("update");
+  unsigned int changed;
+  {
+    CudfUpdater up(doc, info.c_str());
+    std::ifstream is0(solved.c_str());
+    readPackages(is0, up);
+    std::ifstream is1(search.c_str());
+    readPackages(is1, up);
+    changed = up.stats();
+  }
+  ud.stop(npkgs, "pkgs", fileSize(solved) + fileSize(search));
+  phases.push_back(ud);
+
+  out << "# reduction: "
+      << (r == KCudfReducer::RDO_FAIL ? "fail" :
+          r == KCudfReducer::RDO_SOL ? "solved" : "search")
+      << ", search packages: " << srch
+      << ", changed packages: " << changed << std::endl;
+  out << "# tasks:";
+  for (unsigned int i = 0; i < pols.size(); i++)
+    out << (i == 0 ? " " : ", ") << policyName(pols[i]) << " " << tasks[i];
+  out << std::endl;
+  out << std::left << std::setw(12) << "# phase" << std::right
+      << std::setw(10) << "seconds" << std::setw(12) << "items" << " "
+      << std::left << std::setw(9) << "unit" << std::setw(36) << "throughput"
+      << std::right
+      << std::setw(12) << "allocs" << std::setw(12) << "rss(KB)" << std::endl;
+  for (const Phase& p : phases)
+    out << p << std::endl;
+}
+
+void parseCmdOptions(variables_map& vm, UniverseParams& up, int argc, char* argv[]) {
+  options_description general("Available options");
+
+  general.add_options()
+    ("names", value<std::string>()->default_value("10000"),
+     "Comma separated list of numbers of package names, one run per element.\n")
+    ("versions", value<unsigned int>(&up.versions)->default_value(up.versions),
+     "Maximum number of versions per name.\n")
+    ("fanout", value<unsigned int>(&up.fanout)->default_value(up.fanout),
+     "Maximum number of dependencies per package.\n")
+    ("width", value<unsigned int>(&up.width)->default_value(up.width),
+     "Maximum number of terms in a dependency disjunction.\n")
+    ("virtuals", value<unsigned int>(&up.virtuals)->default_value(up.virtuals),
+     "Number of virtual package names.\n")
+    ("provides", value<double>(&up.provides)->default_value(up.provides),
+     "Probability for a package to provide a virtual package.\n")
+    ("conflicts", value<double>(&up.conflicts)->default_value(up.conflicts),
+     "Probability for a package to have a conflict.\n")
+    ("installed", value<double>(&up.installed)->default_value(up.installed),
+     "Ratio of package names with an installed version.\n")
+    ("request", value<unsigned int>(&up.request)->default_value(up.request),
+     "Packages to install and to upgrade in the request.\n")
+    ("seed", value<unsigned int>(&up.seed)->default_value(up.seed),
+     "Seed of the generator.\n")
+    ("schedule", value<std::string>()->default_value("fifo"),
+     "Comma separated list of scheduling policies of the reducer can operations (fifo, lifo, degree, bucket), one reduction per element.\n")
+    ("prefix", value<std::string>()->default_value("kcudf-bench"),
+     "Prefix of the generated files.\n")
+    ("help", "print this message");
+
+  store(command_line_parser(argc, argv).options(general).run(), vm);
+  notify(vm);
+
+  if (vm.count("help")) {
+    std::cout << std::endl << "Example calls:" << std::endl
+              << argv[0] << std::endl
+              << argv[0] << " --names 1000,10000,100000 --fanout 6" << std::endl
+              << std::endl << std::endl << general << std::endl;
+    exit(EXIT_SUCCESS);
+  }
+}
+
+int main(int argc, char **argv) {
+  variables_map vm;
+  UniverseParams up;
+  parseCmdOptions(vm, up, argc, argv);
+
+#ifndef NDEBUG
+  std::cerr << "warning: assertions are enabled, "
+            << "use -DCMAKE_BUILD_TYPE=Release for meaningful numbers" << std::endl;
+#endif
+
+  std::vector<WL_POLICY> pols;
+  std::istringstream sched(vm["schedule"].as<std::string>());
+  std::string pn;
+  while (std::getline(sched, pn, ',')) {
+    WL_POLICY p;
+    if (!policyFromName(pn, p)) {
+      std::cerr << "error: unknown scheduling policy '" << pn << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    pols.push_back(p);
+  }
+  if (pols.empty())
+    pols.push_back(WLP_FIFO);
+
+  // the library reports its progress on the standard streams
+  std::ostringstream sink;
+  std::streambuf *cout_buf = std::cout.rdbuf(sink.rdbuf());
+  std::streambuf *cerr_buf = std::cerr.rdbuf(sink.rdbuf());
+  std::ostream out(cout_buf);
+
+  std::istringstream names(vm["names"].as<std::string>());
+  std::string n;
+  while (std::getline(names, n, ',')) {
+    up.names = std::strtoul(n.c_str(), NULL, 10);
+    std::ostringstream pfx;
+    pfx << vm["prefix"].as<std::string>() << "-" << up.names;
+    // a process per run, so that the peak memory of a run is its own
+    out.flush();
+    pid_t pid = fork();
+    if (pid == 0) {
+      run(up, pfx.str(), pols, out);
+      out << std::endl;
+      out.flush();
+      _exit(EXIT_SUCCESS);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0 ||
+        !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+      out << "# run failed: " << up << std::endl << std::endl;
+      std::cout.rdbuf(cout_buf);
+      std::cerr.rdbuf(cerr_buf);
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout.rdbuf(cout_buf);
+  std::cerr.rdbuf(cerr_buf);
+  return EXIT_SUCCESS;
+}
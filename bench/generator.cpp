@@ -0,0 +1,186 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <bench/generator.hh>
+
+/*
+ * Deterministic random numbers
+ *
+ * The draws are computed from the seed and the position in the document
+ * (package name, version, kind of draw) with a fixed mixing function, so the
+ * same parameters produce the same document on every platform.
+ */
+
+static unsigned long long mix(unsigned long long x) {
+  // splitmix64 finalizer
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/**
+ * \brief Stream of random numbers for one element of the document.
+ */
+class Draw {
+private:
+  /// Current state
+  unsigned long long s;
+public:
+  /// Stream for element \a a, \a b of kind \a k in the universe of seed \a seed
+  Draw(unsigned int seed, unsigned int k, unsigned int a, unsigned int b = 0)
+    : s(mix(mix(mix(seed) ^ k) ^ a) ^ b) {}
+  /// Next number in the stream
+  unsigned long long next(void) {
+    s = mix(s);
+    return s;
+  }
+  /// Number in [0, n)
+  unsigned int below(unsigned int n) {
+    return n == 0 ? 0 : static_cast<unsigned int>(next() % n);
+  }
+  /// True with probability \a p
+  bool chance(double p) {
+    return (next() >> 11) * (1.0 / 9007199254740992.0) < p;
+  }
+};
+
+/// Kinds of draws
+enum DRAW_KIND {
+  DK_VERSIONS = 0, ///> Number of versions of a name
+  DK_INSTALLED,    ///> Installed version of a name
+  DK_PACKAGE,      ///> Relations of a package
+  DK_REQUEST       ///> Request
+};
+
+/// Number of versions of package name \a n
+static unsigned int versions(const UniverseParams& p, unsigned int n) {
+  return 1 + Draw(p.seed, DK_VERSIONS, n).below(p.versions);
+}
+
+/// Installed version of package name \a n (0 if none)
+static unsigned int installed(const UniverseParams& p, unsigned int n) {
+  Draw d(p.seed, DK_INSTALLED, n);
+  if (!d.chance(p.installed)) return 0;
+  return 1 + d.below(versions(p, n));
+}
+
+/// Writes a term of a dependency or conflict on a package other than \a n
+static bool term(std::ostream& os, const UniverseParams& p, Draw& d,
+                 unsigned int n, bool virt) {
+  static const char* ops[] = {" >= ", " <= ", " = ", " != ", " < ", " > "};
+  if (virt && p.virtuals > 0 && d.chance(0.25)) {
+    os << "v" << d.below(p.virtuals);
+    return true;
+  }
+  unsigned int t = d.below(p.names);
+  if (t == n) return false;
+  os << "p" << t;
+  if (d.chance(0.5))
+    os << ops[d.below(6)] << 1 + d.below(versions(p, t));
+  return true;
+}
+
+UniverseParams::UniverseParams(void)
+  : names(10000), versions(4), fanout(4), width(3), virtuals(500),
+    provides(0.1), conflicts(0.1), installed(0.3), request(2), seed(1) {}
+
+std::ostream& operator<< (std::ostream& os, const UniverseParams& p) {
+  return os << "names=" << p.names << " versions=" << p.versions
+            << " fanout=" << p.fanout << " width=" << p.width
+            << " virtuals=" << p.virtuals << " provides=" << p.provides
+            << " conflicts=" << p.conflicts << " installed=" << p.installed
+            << " request=" << p.request << " seed=" << p.seed;
+}
+
+unsigned int generate(std::ostream& os, const UniverseParams& p) {
+  unsigned int pkgs = 0;
+  os << "preamble: " << std::endl << std::endl;
+  for (unsigned int n = 0; n < p.names; n++) {
+    unsigned int nv = versions(p, n);
+    unsigned int iv = installed(p, n);
+    for (unsigned int v = 1; v <= nv; v++) {
+      Draw d(p.seed, DK_PACKAGE, n, v);
+      os << "package: p" << n << '\n'
+         << "version: " << v << '\n';
+      // dependencies
+      unsigned int nd = d.below(p.fanout + 1);
+      bool first = true;
+      for (unsigned int i = 0; i < nd; i++) {
+        unsigned int w = 1 + d.below(p.width);
+        std::ostringstream ds;
+        bool empty = true;
+        for (unsigned int j = 0; j < w; j++) {
+          std::ostringstream ts;
+          if (term(ts, p, d, n, true)) {
+            ds << (empty ? "" : " | ") << ts.str();
+            empty = false;
+          }
+        }
+        if (empty) continue;
+        os << (first ? "depends: " : ", ") << ds.str();
+        first = false;
+      }
+      if (!first) os << '\n';
+      // conflicts
+      if (d.chance(p.conflicts)) {
+        std::ostringstream cs;
+        if (term(cs, p, d, n, false))
+          os << "conflicts: " << cs.str() << '\n';
+      }
+      // provides
+      if (p.virtuals > 0 && d.chance(p.provides))
+        os << "provides: v" << d.below(p.virtuals) << '\n';
+      if (v == iv)
+        os << "installed: true" << '\n';
+      os << '\n';
+      pkgs++;
+    }
+  }
+  // request
+  Draw d(p.seed, DK_REQUEST, 0);
+  os << "request: bench" << '\n';
+  if (p.request > 0 && p.names > 0) {
+    os << "install: ";
+    for (unsigned int i = 0; i < p.request; i++)
+      os << (i == 0 ? "" : ", ") << "p" << d.below(p.names);
+    os << '\n' << "upgrade: ";
+    for (unsigned int i = 0; i < p.request; i++)
+      os << (i == 0 ? "" : ", ") << "p" << d.below(p.names);
+    os << '\n';
+  }
+  os << std::endl;
+  return pkgs;
+}
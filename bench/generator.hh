@@ -0,0 +1,85 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF_BENCH_GENERATOR_HH__
+#define __KCUDF_BENCH_GENERATOR_HH__
+
+#include <iostream>
+
+/**
+ * \brief Parameters of a synthetic package universe.
+ *
+ * A universe has \a names package names, each one with between 1 and \a
+ * versions versions. The shape of every package (versions, relations,
+ * installed state) only depends on the seed and on its name, so universes of
+ * millions of packages are generated without keeping anything in memory.
+ */
+class UniverseParams {
+public:
+  /// Number of package names
+  unsigned int names;
+  /// Maximum number of versions per name
+  unsigned int versions;
+  /// Maximum number of dependencies per package
+  unsigned int fanout;
+  /// Maximum number of terms in a dependency disjunction
+  unsigned int width;
+  /// Number of virtual (only provided) names
+  unsigned int virtuals;
+  /// Probability for a package to provide a virtual name
+  double provides;
+  /// Probability for a package to have a conflict
+  double conflicts;
+  /// Ratio of names with an installed version
+  double installed;
+  /// Number of packages in each part (install, upgrade) of the request
+  unsigned int request;
+  /// Seed for the generator
+  unsigned int seed;
+  /// Constructor with the default universe
+  UniverseParams(void);
+};
+
+/// Output the parameters \a p on stream \a os
+std::ostream& operator<< (std::ostream& os, const UniverseParams& p);
+
+/**
+ * \brief Writes on \a os the cudf document (universe and request) described by
+ * \a p. The same parameters always produce the same document.
+ *
+ * The return value is the number of packages in the document.
+ */
+unsigned int generate(std::ostream& os, const UniverseParams& p);
+
+#endif
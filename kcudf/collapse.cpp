@@ -0,0 +1,206 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <kcudf/collapse.hh>
+
+/*
+ * KCudfCollapseWriter
+ */
+KCudfCollapseWriter::KCudfCollapseWriter(KCudfWriter& w)
+  : KCudfBufferWriter(w) {}
+
+KCudfCollapseWriter::~KCudfCollapseWriter(void) {}
+
+void KCudfCollapseWriter::flush(KCudfMerging& m) {
+  KCUDF_TRACE_SCOPE("collapse");
+  const unsigned int NONE = ~0u;
+  const unsigned int n = pkgs.size();
+  const std::map<unsigned int, unsigned int> idx = index();
+  std::vector<std::vector<unsigned int> > out(n);
+  for (auto& r : deps) {
+    auto i = idx.find(r.first), j = idx.find(r.second);
+    if (i != idx.end() && j != idx.end() && i != j)
+      out[i->second].push_back(j->second);
+  }
+
+  // strongly connected components (Tarjan, without recursion)
+  std::vector<unsigned int> index(n, NONE), low(n), comp(n, NONE);
+  std::vector<unsigned int> stack;
+  std::vector<std::pair<unsigned int, unsigned int> > calls;
+  unsigned int counter = 0, ncomp = 0;
+  for (unsigned int s = 0; s < n; s++) {
+    if (index[s] != NONE) continue;
+    index[s] = low[s] = counter++;
+    stack.push_back(s);
+    calls.push_back(std::make_pair(s, 0));
+    while (!calls.empty()) {
+      const unsigned int v = calls.back().first;
+      if (calls.back().second < out[v].size()) {
+        const unsigned int w = out[v][calls.back().second++];
+        if (index[w] == NONE) {
+          index[w] = low[w] = counter++;
+          stack.push_back(w);
+          calls.push_back(std::make_pair(w, 0));
+        } else if (comp[w] == NONE) {
+          low[v] = std::min(low[v], index[w]);
+        }
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty())
+        low[calls.back().first] = std::min(low[calls.back().first], low[v]);
+      if (low[v] == index[v]) {
+        unsigned int w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          comp[w] = ncomp;
+        } while (w != v);
+        ncomp++;
+      }
+    }
+  }
+  out.clear();
+  index.clear();
+  low.clear();
+
+  /*
+    A package providing itself can always be installed as far as provides are
+    concerned. Any other one needs one of its own providers (none means it
+    cannot be installed), a component only collapses one of them with the
+    free members and the others stay in the contracted cycle.
+  */
+  std::vector<bool> selfp(n, false);
+  for (auto& r : pvds) {
+    auto i = idx.find(r.second);
+    if (r.first == r.second && i != idx.end()) selfp[i->second] = true;
+  }
+  std::vector<std::vector<unsigned int> > members(ncomp);
+  std::vector<unsigned int> constrained(ncomp, NONE);
+  for (unsigned int i = 0; i < n; i++) {
+    if (!selfp[i]) {
+      if (constrained[comp[i]] != NONE) continue;
+      constrained[comp[i]] = i;
+    }
+    members[comp[i]].push_back(i);
+  }
+
+  // representatives and classes
+  std::vector<unsigned int> rep(n);
+  std::vector<bool> collapsed(n, false);
+  for (unsigned int i = 0; i < n; i++)
+    rep[i] = i;
+  std::set<unsigned int> selfc;
+  for (std::vector<unsigned int>& c : members) {
+    if (c.size() < 2) continue;
+    // keep install before keep, keep before install, first member on ties
+    auto rank = [&](unsigned int i) -> unsigned int {
+      return 2 * std::get<1>(pkgs[i]) + std::get<2>(pkgs[i]);
+    };
+    unsigned int r = c.front();
+    bool ki = false, ku = false;
+    for (unsigned int i : c) {
+      bool keep = std::get<1>(pkgs[i]), install = std::get<2>(pkgs[i]);
+      if (rank(i) > rank(r)) r = i;
+      ki = ki || (keep && install);
+      ku = ku || (keep && !install);
+    }
+    for (unsigned int i : c) {
+      rep[i] = r;
+      collapsed[i] = true;
+    }
+    if (ki && ku)
+      selfc.insert(r);
+    KCudfMerging::Class mc;
+    mc.rep = std::get<0>(pkgs[r]);
+    mc.all = true;
+    for (unsigned int i : c)
+      if (i != r) mc.members.push_back(std::get<0>(pkgs[i]));
+    m.add(mc);
+  }
+  members.clear();
+
+  // collapsed problem
+  auto id = [&](unsigned int p) -> unsigned int {
+    auto i = idx.find(p);
+    return i == idx.end() ? p : std::get<0>(pkgs[rep[i->second]]);
+  };
+  std::vector<std::vector<unsigned int> > gs;
+  for (auto& g : groups) {
+    std::vector<unsigned int> ng;
+    for (unsigned int p : g)
+      ng.push_back(id(p));
+    std::sort(ng.begin(), ng.end());
+    for (size_t i = 1; i < ng.size(); i++)
+      if (ng[i] == ng[i - 1])
+        // two members of the group in the same component
+        confs.push_back(std::make_pair(ng[i], ng[i]));
+    ng.erase(std::unique(ng.begin(), ng.end()), ng.end());
+    if (ng.size() > 1)
+      gs.push_back(ng);
+  }
+  for (unsigned int r : selfc)
+    confs.push_back(std::make_pair(std::get<0>(pkgs[r]), std::get<0>(pkgs[r])));
+
+  for (unsigned int i = 0; i < n; i++)
+    if (rep[i] == i)
+      wrt.package(std::get<0>(pkgs[i]), std::get<1>(pkgs[i]),
+                  std::get<2>(pkgs[i]), "");
+  rewrite(deps, id, false, false);
+  for (auto& r : deps)
+    wrt.dependency(r.first, r.second, "");
+  rewrite(confs, id, true, true);
+  for (auto& r : confs)
+    wrt.conflict(r.first, r.second, "");
+  for (auto& g : gs)
+    wrt.atMostOne(g, "");
+  /*
+    The representative of a class keeps the providers of its constrained
+    member, or provides itself when all the members are free.
+  */
+  std::vector<relation_t> kept;
+  for (auto& r : pvds) {
+    auto i = idx.find(r.second);
+    if (i == idx.end() || !collapsed[i->second])
+      kept.push_back(r);
+    else if (constrained[comp[i->second]] == NONE ?
+             r.first == r.second : constrained[comp[i->second]] == i->second)
+      kept.push_back(r);
+  }
+  pvds.swap(kept);
+  rewrite(pvds, id, false, true);
+  for (auto& r : pvds)
+    wrt.provides(r.first, r.second, "");
+  clear();
+}
@@ -0,0 +1,89 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__COLLAPSE__HH__
+#define __KCUDF__COLLAPSE__HH__
+
+#include <kcudf/kcudf.hh>
+#include <kcudf/merge.hh>
+
+/**
+ * \file Collapsing of dependency cycles.
+ *
+ * All the packages of a cycle of dependencies must have the same install
+ * state, so every strongly connected component of the dependency graph is
+ * replaced by one representative. Relations are redirected to the
+ * representatives and the ones inside a component disappear, except
+ * conflicts and at-most-one groups between its members that become a conflict
+ * of the representative with itself (none of them can be installed).
+ *
+ * A package that does not provide itself needs one of its own providers, so
+ * at most one of them is collapsed with the members that provide themselves
+ * and the representative gets its providers. The others keep their identity
+ * and stay equal to the representative through the contracted cycle.
+ *
+ * The representative is a member marked keep install if there is one, a
+ * member marked keep otherwise, then an installed member, and the first
+ * member in any other case. A component with members to keep installed and
+ * uninstalled has no solution, it also gets a conflict with itself.
+ *
+ * Paranoid packages collapsed into a representative are passed on to it by
+ * \a KCudfReducer::collapsed.
+ *
+ * The components are stored as \a KCudfMerging classes where all the members
+ * follow the representative, a solution is expanded back with \a
+ * KCudfExpandWriter.
+ */
+
+/**
+ * \brief Writer that collapses the dependency cycles of the problem it
+ * receives before passing it to \a wrt.
+ *
+ * The problem is buffered and written by \a flush, in the order packages,
+ * dependencies, conflicts, at-most-one groups and provides.
+ */
+class KCudfCollapseWriter final : public KCudfBufferWriter {
+public:
+  /// Constructor for a writer passing the collapsed problem to \a w
+  KCudfCollapseWriter(KCudfWriter& w);
+  /// Destructor
+  virtual ~KCudfCollapseWriter(void);
+  /**
+   * \brief Collapses the dependency cycles, stores the components in \a m
+   * and writes the collapsed problem. It can only be called once.
+   */
+  void flush(KCudfMerging& m);
+};
+
+#endif
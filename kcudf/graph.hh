@@ -68,6 +68,11 @@ private:
 public:
   /// \name Type definition for the graph
   //@{
+  /**
+   * Out edges are kept in a set: parallel edges are ignored and
+   * boost::edge(u,v,g) is logarithmic in the degree of u, also while edges
+   * are being added.
+   */
   typedef
       typename boost::adjacency_list<boost::setS,boost::listS,D,Index> type;
   typedef
@@ -35,6 +35,7 @@
  */
 
 #include <assert.h>
+#include <algorithm>
 
 #include <kcudf/gwriter.hh>
 
@@ -53,6 +54,16 @@ namespace std {
 }
 
 
+/// Estimated heap bytes of graph \a g (vertices, edge list and incidence sets)
+template <class Graph>
+static size_t graphBytes(const Graph& g) {
+  typedef typename Graph::EdgeContainer::value_type list_edge;
+  // every edge is in two incidence sets: out and in, or the ones of both ends
+  return num_vertices(g) * heapBlock(LIST_NODE + sizeof(typename Graph::stored_vertex))
+    + num_edges(g) * (2 * heapBlock(TREE_NODE + sizeof(typename Graph::StoredEdge))
+                      + heapBlock(LIST_NODE + sizeof(list_edge)));
+}
+
 /*
  * GraphWriter
  */
@@ -106,6 +117,19 @@ void GraphWriter::provides(unsigned int id, unsigned int id2, const char*) {
            pvds);
 }
 
+void GraphWriter::atMostOne(const std::vector<unsigned int>& g, const char*) {
+  std::vector<unsigned int> m(g);
+  sort(m.begin(), m.end());
+  m.erase(unique(m.begin(), m.end()), m.end());
+  if (m.size() < 2) return;
+  unsigned int gid = groupsv.size();
+  for (unsigned int p : m) {
+    assert(isPackage(p));
+    groupsm[p].push_back(gid);
+  }
+  groupsv.push_back(m);
+}
+
 /*
  * Packages
  */
@@ -149,6 +173,13 @@ unsigned int GraphWriter::internalId(unsigned int p) const {
  return get(vertex_index,deps)[get<0>(nodesm.at(p))];
 }
 
+unsigned int GraphWriter::degree(unsigned int p) const {
+  const nodes_tuple_t& n = nodesm.at(p);
+  return out_degree(get<0>(n),deps) + in_degree(get<0>(n),deps) +
+    out_degree(get<1>(n),confs) + out_degree(get<2>(n),pvds) +
+    in_degree(get<2>(n),pvds) + groups(p).size();
+}
+
 /*
  * Dependencies
  */
@@ -181,9 +212,9 @@ GraphWriter::depender_range GraphWriter::dependers(unsigned int p) const {
 
 bool GraphWriter::dependency(unsigned int p, unsigned int q) const {
   assert(isPackage(p));
-  for (unsigned int d : dependencies(p))
-    if (d == q) return true;
-  return false;
+  assert(isPackage(q));
+  // out edges are stored in a set: this is a lookup and not a scan
+  return edge(get<0>(nodesm.at(p)), get<0>(nodesm.at(q)), deps).second;
 }
 /*
  * Conflicts
@@ -213,11 +244,34 @@ GraphWriter::conflict_range GraphWriter::conflicts(unsigned int p) const {
 
 bool GraphWriter::conflict(unsigned int p, unsigned int q) const {
   assert(isPackage(p));
-  for (unsigned int c : conflicts(p))
-    if (c == q) return true;
+  assert(isPackage(q));
+  if (edge(get<1>(nodesm.at(p)), get<1>(nodesm.at(q)), confs).second)
+    return true;
+  if (p != q)
+    for (unsigned int g : groups(p))
+      if (binary_search(groupsv[g].begin(), groupsv[g].end(), q))
+        return true;
   return false;
 }
 
+/*
+ * At-most-one groups
+ */
+
+unsigned int GraphWriter::numGroups(void) const {
+  return groupsv.size();
+}
+
+const std::vector<unsigned int>& GraphWriter::group(unsigned int g) const {
+  return groupsv.at(g);
+}
+
+const std::vector<unsigned int>& GraphWriter::groups(unsigned int p) const {
+  static const std::vector<unsigned int> none;
+  auto g = groupsm.find(p);
+  return g == groupsm.end() ? none : g->second;
+}
+
 /*
  * Provides
  */
@@ -265,9 +319,8 @@ GraphWriter::provider_range GraphWriter::providers(unsigned int p) const {
 
 bool GraphWriter::provides(unsigned int p, unsigned int q) const {
   assert(isPackage(p));
-  for (unsigned int v : provides(p))
-    if (v == q) return true;
-  return false;
+  assert(isPackage(q));
+  return edge(get<2>(nodesm.at(p)), get<2>(nodesm.at(q)), pvds).second;
 }
 
 /*
@@ -281,3 +334,19 @@ const Digraph::type& GraphWriter::getDeps(void) const { return deps; }
 Ugraph::type& GraphWriter::getConfs(void) { return confs; }
 
 Digraph::type& GraphWriter::getPvds(void) { return pvds; }
+
+void GraphWriter::memory(MemoryReport& r) const {
+  r.add("GraphWriter::deps", num_edges(deps), graphBytes(deps));
+  r.add("GraphWriter::confs", num_edges(confs), graphBytes(confs));
+  r.add("GraphWriter::pvds", num_edges(pvds), graphBytes(pvds));
+  r.add("GraphWriter::nodesm", nodesm.size(), heapBytes(nodesm));
+  r.add("GraphWriter::statem", statem.size(), heapBytes(statem));
+  size_t c = 0, b = heapBytes(groupsv) + heapBytes(groupsm);
+  for (const std::vector<unsigned int>& g : groupsv) {
+    c += g.size();
+    b += heapBytes(g);
+  }
+  for (auto g = groupsm.begin(); g != groupsm.end(); ++g)
+    b += heapBytes(g->second);
+  r.add("GraphWriter groups", c, b);
+}
@@ -76,6 +76,10 @@ protected:
   nodes_map_t nodesm;
   /// State of the packages
   nodes_state_t statem;
+  /// At-most-one groups, every group is sorted
+  std::vector<std::vector<unsigned int> > groupsv;
+  /// Groups (indices in \a groupsv) each package belongs to
+  std::map<unsigned int, std::vector<unsigned int> > groupsm;
 public:
   /// \name Iterator types returned by methods of this class
   //@{
@@ -142,14 +146,20 @@ public:
   //@}
   /// \name Writer implementation
   //@{
+  /*
+    Relations are final: they are resolved at compile time when the writer is
+    used through \a read or \a KCudfTranslator::translate.
+  */
   /// Process package \a p
   void package(unsigned int p, bool keep, bool install, const char*);
   /// Process dependency between packages \a p and \a q
-  void dependency(unsigned int p, unsigned int q, const char*);
+  void dependency(unsigned int p, unsigned int q, const char*) final;
   /// Process conflict between packages \a p and \a q
-  void conflict(unsigned int p, unsigned int q, const char*);
+  void conflict(unsigned int p, unsigned int q, const char*) final;
   /// Process provides between packages \a p and \a q
-  void provides(unsigned int p, unsigned int q, const char*);
+  void provides(unsigned int p, unsigned int q, const char*) final;
+  /// Process an at-most-one group among the packages in \a g
+  void atMostOne(const std::vector<unsigned int>& g, const char*) final;
   //@}
   /// \name Package information
   //@{
@@ -179,6 +189,13 @@ public:
    * algorithms but I have found it also useful in other contexts (solver).
    */
   unsigned int internalId(unsigned int p) const;
+  /**
+   * \brief Number of relations of package \a p: dependencies, dependers,
+   * conflicts, provides, providers and at-most-one groups.
+   *
+   * \warning Complexity: O(log |V|)
+   */
+  unsigned int degree(unsigned int p) const;
   //@}
   /// \name Dependency information
   //@{
@@ -221,7 +238,7 @@ public:
   /**
    * \brief Tests whether there is a dependency between packages \a p and \a q
    *
-   * \warning Complexity: O(|E| * log |V|)
+   * \warning Complexity: O(log |V| + log out_degree(p))
    */
   bool dependency(unsigned int p, unsigned int q) const;
   //@}
@@ -251,10 +268,30 @@ public:
   /**
    * \brief Tests whether there is a conflict between packages \a p and \a q
    *
-   * \warning Complexity: O(|E| * log |V|)
+   * Packages in the same at-most-one group are also conflicting.
+   *
+   * \warning Complexity: O(log |V| + log degree(p)) plus a binary search on
+   * each group of \a p
    */
   bool conflict(unsigned int p, unsigned int q) const;
   //@}
+  /// \name At-most-one group information
+  //@{
+  /// Number of at-most-one groups
+  unsigned int numGroups(void) const;
+  /**
+   * \brief Packages of group \a g, in increasing order
+   *
+   * \warning Complexity: O(1)
+   */
+  const std::vector<unsigned int>& group(unsigned int g) const;
+  /**
+   * \brief Groups package \a p belongs to
+   *
+   * \warning Complexity: O(log |V|)
+   */
+  const std::vector<unsigned int>& groups(unsigned int p) const;
+  //@}
   /// \name Provides information
   //@{
   /// Number of provides
@@ -293,7 +330,7 @@ public:
   /**
    * \brief Tests whether package \a p provides package \a q
    *
-   * \warning Complexity: O(|E| * log |V|)
+   * \warning Complexity: O(log |V| + log out_degree(p))
    */
   bool provides(unsigned int p, unsigned int q) const;
   //@}
@@ -307,6 +344,8 @@ public:
   /// Return the graph of provides
   Digraph::type& getPvds(void);
   //@}
+  /// Adds the memory used by the graphs and maps to report \a r
+  virtual void memory(MemoryReport& r) const;
 };
 
 #endif
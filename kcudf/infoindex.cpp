@@ -0,0 +1,201 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <kcudf/infoindex.hh>
+
+namespace {
+  /// Magic number of an info index ("KCIX")
+  const unsigned int INFO_MAGIC = 0x5849434b;
+  /// Version of the format
+  const unsigned int INFO_VERSION = 1;
+  /// Number of fields in the header
+  const unsigned int INFO_HEADER = 5;
+}
+
+/*
+ * KCudfInfoIndexWriter
+ */
+KCudfInfoIndexWriter::KCudfInfoIndexWriter(const char* f)
+  : KCudfInfoWriter(), fname(f), closed(false) {}
+
+void KCudfInfoIndexWriter::entry(unsigned int id, const char* name,
+                                 unsigned int version, INFO_KIND k) {
+  auto n = namei.insert(std::make_pair(std::string(name), names.size()));
+  if (n.second)
+    names.push_back(&n.first->first);
+  if (entries.size() < 3 * (id + 1))
+    entries.resize(3 * (id + 1), 0);
+  entries[3 * id] = n.first->second;
+  entries[3 * id + 1] = version;
+  entries[3 * id + 2] = k;
+}
+
+void KCudfInfoIndexWriter::package(unsigned int id, unsigned int version,
+                                   const char* name) {
+  entry(id, name, version, IK_CONCRETE);
+}
+
+void KCudfInfoIndexWriter::artificial(unsigned int id, const char* desc) {
+  entry(id, desc, 0, IK_ARTIFICIAL);
+}
+
+KCudfInfoIndexWriter::~KCudfInfoIndexWriter(void) {
+  try {
+    close();
+  } catch (FailedStream&) {}
+}
+
+void KCudfInfoIndexWriter::close(void) {
+  if (closed)
+    return;
+  closed = true;
+  std::vector<unsigned int> offsets;
+  offsets.reserve(names.size() + 1);
+  unsigned int chars = 0;
+  for (const std::string* n : names) {
+    offsets.push_back(chars);
+    chars += n->size() + 1;
+  }
+  offsets.push_back(chars);
+  const unsigned int header[INFO_HEADER] =
+    {INFO_MAGIC, INFO_VERSION, static_cast<unsigned int>(names.size()),
+     static_cast<unsigned int>(entries.size() / 3), chars};
+
+  std::ofstream os(fname.c_str(), std::ios::binary | std::ios::trunc);
+  os.write(reinterpret_cast<const char*>(header), sizeof(header));
+  os.write(reinterpret_cast<const char*>(offsets.data()),
+           offsets.size() * sizeof(unsigned int));
+  os.write(reinterpret_cast<const char*>(entries.data()),
+           entries.size() * sizeof(unsigned int));
+  for (const std::string* n : names)
+    os.write(n->c_str(), n->size() + 1);
+  os.close();
+  if (!os)
+    throw FailedStream("unable to write the info index");
+}
+
+/*
+ * KCudfInfoIndex
+ */
+KCudfInfoIndex::KCudfInfoIndex(const char* fname)
+  : base(NULL), len(0) {
+  int fd = open(fname, O_RDONLY);
+  if (fd < 0)
+    throw KCudfInvalidInfoIndex("unable to open info index");
+  struct stat sb;
+  if (fstat(fd, &sb) != 0 || sb.st_size < static_cast<off_t>(INFO_HEADER * sizeof(unsigned int))) {
+    close(fd);
+    throw KCudfInvalidInfoIndex("info index too short");
+  }
+  len = sb.st_size;
+  void *m = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (m == MAP_FAILED)
+    throw KCudfInvalidInfoIndex("unable to map info index");
+  base = static_cast<const unsigned int*>(m);
+
+  const char *err = NULL;
+  if (base[0] != INFO_MAGIC)
+    err = "not an info index (or written with another byte order)";
+  else if (base[1] != INFO_VERSION)
+    err = "unsupported info index version";
+  nnames = base[2];
+  nids = base[3];
+  if (err == NULL &&
+      (INFO_HEADER + static_cast<size_t>(nnames) + 1
+       + 3 * static_cast<size_t>(nids)) * sizeof(unsigned int)
+      + base[4] != len)
+    err = "corrupted info index";
+  if (err == NULL) {
+    offsets = base + INFO_HEADER;
+    entries = offsets + nnames + 1;
+    chars = reinterpret_cast<const char*>(entries + 3 * static_cast<size_t>(nids));
+    err = check();
+  }
+  if (err != NULL) {
+    munmap(const_cast<unsigned int*>(base), len);
+    throw KCudfInvalidInfoIndex(err);
+  }
+}
+
+const char* KCudfInfoIndex::check(void) const {
+  // names are contiguous, non overlapping and ended by a zero byte
+  if (offsets[0] != 0 || offsets[nnames] != base[4])
+    return "corrupted info index name table";
+  for (unsigned int i = 0; i < nnames; i++)
+    if (offsets[i] >= offsets[i + 1] || offsets[i + 1] > base[4]
+        || chars[offsets[i + 1] - 1] != '\0')
+      return "corrupted info index name table";
+  for (unsigned int id = 0; id < nids; id++) {
+    unsigned int k = entries[3 * id + 2];
+    if (k > IK_ARTIFICIAL || (k != IK_NONE && entries[3 * id] >= nnames))
+      return "corrupted info index entry";
+  }
+  return NULL;
+}
+
+KCudfInfoIndex::~KCudfInfoIndex(void) {
+  munmap(const_cast<unsigned int*>(base), len);
+}
+
+bool KCudfInfoIndex::isIndex(const char* fname) {
+  unsigned int magic = 0;
+  FILE *f = fopen(fname, "rb");
+  if (f == NULL)
+    return false;
+  size_t n = fread(&magic, sizeof(magic), 1, f);
+  fclose(f);
+  return n == 1 && magic == INFO_MAGIC;
+}
+
+void KCudfInfoIndex::read(KCudfInfoWriter& wrt) const {
+  for (unsigned int id = 0; id < nids; id++) {
+    switch (kind(id)) {
+    case IK_NONE:
+      break;
+    case IK_CONCRETE:
+      wrt.package(id, version(id), name(id));
+      break;
+    case IK_ARTIFICIAL:
+      wrt.artificial(id, name(id));
+      break;
+    }
+  }
+}
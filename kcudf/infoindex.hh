@@ -0,0 +1,178 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__INFOINDEX__HH__
+#define __KCUDF__INFOINDEX__HH__
+
+#include <kcudf/kcudf.hh>
+
+/**
+ * \file Compact and indexed info files.
+ *
+ * An info index stores the same information as a text info file in a binary
+ * form that is used in place (it is mapped in memory, not parsed). All the
+ * fields are 32 bit unsigned integers in the byte order of the machine that
+ * wrote it:
+ *
+ * - header: magic, format version, number of names, number of ids and size of
+ *   the name table in bytes.
+ * - name offsets: one per name plus the end of the last one.
+ * - entries: for every id from 0 to the number of ids - 1, the index of its
+ *   name, its version and its kind (\a INFO_KIND).
+ * - name table: the names, each one ended by a zero byte. Every name is
+ *   stored once.
+ *
+ * Artificial packages are flagged by their kind; their name is the
+ * description given by the translator (usually empty) and their version is 0.
+ *
+ * Every offset and entry is validated when the index is mapped (linear in its
+ * size); the queries are constant time afterwards.
+ */
+
+/// Kind of an identifier in an info index
+enum INFO_KIND {
+  IK_NONE = 0,   ///> The identifier is not used
+  IK_CONCRETE,   ///> Concrete package with a name and a version
+  IK_ARTIFICIAL  ///> Artificial package created by the translator
+};
+
+/**
+ * \brief Exception for files that are not valid info indexes.
+ */
+class KCudfInvalidInfoIndex : public KCudfFailure {
+public:
+  KCudfInvalidInfoIndex(const char* s) : KCudfFailure(s) { }
+};
+
+/**
+ * \brief Info writer that writes an info index to a file.
+ *
+ * The index is built in memory and written by \a close (or when the writer
+ * is destroyed).
+ */
+class KCudfInfoIndexWriter final : public KCudfInfoWriter {
+private:
+  /// Name of the output file
+  std::string fname;
+  /// Index of every name in \a names
+  std::map<std::string, unsigned int> namei;
+  /// Names in order of index
+  std::vector<const std::string*> names;
+  /// Entries (name, version, kind) for every id
+  std::vector<unsigned int> entries;
+  /// Whether the file was already written
+  bool closed;
+  /// Adds an entry for \a id
+  void entry(unsigned int id, const char* name, unsigned int version, INFO_KIND k);
+  /// Default constructor
+  KCudfInfoIndexWriter(void);
+public:
+  /// Constructor for writing to file \a fname
+  KCudfInfoIndexWriter(const char* fname);
+  /// Destructor, writes the index if \a close was not called (ignoring errors)
+  virtual ~KCudfInfoIndexWriter(void);
+  /**
+   * \brief Writes the index, throws \a FailedStream if it cannot be written
+   * completely. Later calls do nothing.
+   */
+  void close(void);
+  /// Registers concrete package \a id
+  virtual void package(unsigned int id, unsigned int version, const char* name);
+  /// Registers artificial package \a id
+  virtual void artificial(unsigned int id, const char* desc);
+};
+
+/**
+ * \brief Info index mapped in memory.
+ *
+ * All the queries are constant time and do not copy any data.
+ */
+class KCudfInfoIndex {
+private:
+  /// Mapped file
+  const unsigned int *base;
+  /// Size of the mapping in bytes
+  size_t len;
+  /// Number of names
+  unsigned int nnames;
+  /// Number of identifiers
+  unsigned int nids;
+  /// Name offsets
+  const unsigned int *offsets;
+  /// Entries
+  const unsigned int *entries;
+  /// Name table
+  const char *chars;
+  /// Default constructor
+  KCudfInfoIndex(void);
+  /// Copy constructor
+  KCudfInfoIndex(const KCudfInfoIndex&);
+  /**
+   * \brief Validates every name offset and entry, so that the queries never
+   * read out of the mapping. Returns the problem found or NULL.
+   */
+  const char* check(void) const;
+public:
+  /**
+   * \brief Maps the info index \a fname.
+   *
+   * Throws \a KCudfInvalidInfoIndex if the file cannot be mapped or is not a
+   * valid index.
+   */
+  KCudfInfoIndex(const char* fname);
+  /// Destructor, unmaps the file
+  ~KCudfInfoIndex(void);
+  /// Tests whether file \a fname is an info index
+  static bool isIndex(const char* fname);
+  /// Number of identifiers (the largest one plus one)
+  unsigned int size(void) const {
+    return nids;
+  }
+  /// Kind of identifier \a id
+  INFO_KIND kind(unsigned int id) const {
+    return id < nids ? static_cast<INFO_KIND>(entries[3 * id + 2]) : IK_NONE;
+  }
+  /// Name of \a id (or description if artificial), only if it is used
+  const char* name(unsigned int id) const {
+    return chars + offsets[entries[3 * id]];
+  }
+  /// Version of \a id, only if it is used
+  unsigned int version(unsigned int id) const {
+    return entries[3 * id + 1];
+  }
+  /// Passes every identifier of the index to \a wrt
+  void read(KCudfInfoWriter& wrt) const;
+};
+
+#endif
@@ -38,9 +38,15 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <memory>
+#include <numeric>
+#include <algorithm>
 #include <kcudf/kcudf.hh>
+#include <kcudf/infoindex.hh>
+#include <kcudf/renumber.hh>
+#include <kcudf/merge.hh>
 
-unsigned int Package::next_id = 0;
+thread_local unsigned int Package::next_id = 0;
 
 Package::Package(bool inst, int v)
   : install(inst), keep(false), id(next_id), version(v), info(), keep_info() {
@@ -49,6 +55,10 @@ Package::Package(bool inst, int v)
 
 Package::~Package(void) {}
 
+void Package::resetIds(void) {
+  next_id = 0;
+}
+
 unsigned int Package::getId(void) const {
   return id;
 }
@@ -115,6 +125,13 @@ void Package::addKeepInfo(const char* ninf) {
   keep_info.append(ninf);
 }
 
+void Package::memory(MemoryReport& r) const {
+  r.add("Package relation sets",
+        dependencies.size() + conflicts.size() + provides.size(),
+        heapBytes(dependencies) + heapBytes(conflicts) + heapBytes(provides));
+  r.add("Package info strings", 2, heapBytes(info) + heapBytes(keep_info));
+}
+
 // SelfPackage
 SelfPackage::SelfPackage(const std::string& name, bool inst, int v)
   : Package(inst,v), nm(name) {
@@ -130,6 +147,11 @@ const std::string& SelfPackage::name(void) const {
 
 SelfPackage::~SelfPackage(void) {}
 
+void SelfPackage::memory(MemoryReport& r) const {
+  r.add("Package objects", 1, heapBlock(sizeof(SelfPackage)) + heapBytes(nm));
+  Package::memory(r);
+}
+
 bool SelfPackage::isConcrete(void) const {
   return true;
 }
@@ -245,6 +267,12 @@ bool Disjunction::markedKeep(void) const {
   return Package::markedKeep();
 }
 
+void Disjunction::memory(MemoryReport& r) const {
+  r.add("Package objects", 1, heapBlock(sizeof(Disjunction)));
+  r.add("Disjunction provider sets", providers.size(), heapBytes(providers));
+  Package::memory(r);
+}
+
 bool Disjunction::isFlat(void) const {
   if (forwarded) {
     assert(!fwd->isConcrete());
@@ -294,6 +322,14 @@ void Disjunction::flat(std::map<unsigned int,Package*>& pkgs) {
   flt = true;
 }
 
+unsigned int Disjunction::forwardLength(void) const {
+  if (!forwarded)
+    return 0;
+  if (fwd->isConcrete())
+    return 1;
+  return 1 + static_cast<const Disjunction*>(fwd)->forwardLength();
+}
+
 void Disjunction::setForward(Package *p) {
   if (forwarded) {
     assert(!fwd->isConcrete());
@@ -332,34 +368,195 @@ void Disjunction::setForward(Package *p) {
   info.append(sf.str());
 }
 
+// Phase statistics
+unsigned long long (*PhaseStats::allocations)(void) = NULL;
+
+PhaseStats::PhaseStats(const char* n)
+  : name(n), runs(0), secs(0), allocs(0) {}
+
+PhaseTimer::PhaseTimer(std::vector<PhaseStats>& phs, const char* n)
+  : phases(phs), name(n), start(clock::now()),
+    allocs(PhaseStats::allocations ? PhaseStats::allocations() : 0) {}
+
+PhaseTimer::~PhaseTimer(void) {
+  clock::time_point end = clock::now();
+#ifdef KCUDF_TRACE
+  Trace::event(name, start, end);
+#endif
+  double secs = std::chrono::duration<double>(end - start).count();
+  unsigned long long a =
+    PhaseStats::allocations ? PhaseStats::allocations() - allocs : 0;
+  auto ph = std::find_if(phases.begin(), phases.end(),
+                         [this](const PhaseStats& p) { return p.name == name; });
+  if (ph == phases.end())
+    ph = phases.insert(phases.end(), PhaseStats(name));
+  ph->runs++;
+  ph->secs += secs;
+  ph->allocs += a;
+}
+
+// Cancellation
+CancelToken::CancelToken(void)
+  : cancelled_(false), deadline_(std::numeric_limits<clock::rep>::max()) {}
+
+void CancelToken::cancel(void) {
+  cancelled_ = true;
+}
+
+void CancelToken::deadline(double secs) {
+  clock::time_point t = clock::now() +
+    std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(secs));
+  deadline_ = t.time_since_epoch().count();
+}
+
+void CancelToken::reset(void) {
+  cancelled_ = false;
+  deadline_ = std::numeric_limits<clock::rep>::max();
+}
+
+bool CancelToken::cancelled(void) const {
+  return cancelled_;
+}
+
+bool CancelToken::expired(void) const {
+  if (cancelled_)
+    return true;
+  clock::rep d = deadline_;
+  return d != std::numeric_limits<clock::rep>::max() &&
+    clock::now().time_since_epoch().count() >= d;
+}
+
+void writeJson(std::ostream& os, const std::vector<PhaseStats>& phases) {
+  os << "[";
+  for (auto ph = phases.begin(); ph != phases.end(); ++ph) {
+    if (ph != phases.begin())
+      os << ",";
+    os << "\n    {\"name\": \"" << ph->name << "\", \"runs\": " << ph->runs
+       << ", \"seconds\": " << ph->secs << ", \"allocs\": " << ph->allocs << "}";
+  }
+  os << "\n  ]";
+}
+
+/// Output the histogram \a h on \a os as a json array
+static void writeJson(std::ostream& os, const std::vector<unsigned int>& h) {
+  os << "[";
+  for (auto i = h.begin(); i != h.end(); ++i)
+    os << (i == h.begin() ? "" : ", ") << *i;
+  os << "]";
+}
+
 // Translator statistics
-TranslatorStats::TranslatorStats(void)
-  : cp(0), rd(0), ed(0), zp(0), fail(false) {}
+TranslatorStats::TranslatorStats(bool memory)
+  : cp(0), rd(0), ed(0), zp(0), pruned(0), fail(false),
+    pkgs(0), constv(0), specv(0), specv_versions(0), memory(memory) {}
+
+void writeJson(std::ostream& os, const TranslatorStats& st) {
+  os << "{\n"
+     << "  \"fail\": " << (st.fail ? "true" : "false") << ",\n"
+     << "  \"concrete\": " << st.cp << ",\n"
+     << "  \"disjunctions\": " << st.rd << ",\n"
+     << "  \"equal_disjunctions\": " << st.ed << ",\n"
+     << "  \"zero_provider_disjunctions\": " << st.zp << ",\n"
+     << "  \"pruned\": " << st.pruned << ",\n"
+     << "  \"packages\": " << st.pkgs << ",\n"
+     << "  \"constv\": " << st.constv << ",\n"
+     << "  \"specv\": " << st.specv << ",\n"
+     << "  \"specv_versions\": " << st.specv_versions << ",\n"
+     << "  \"forward_chains\": ";
+  writeJson(os, st.fwd);
+  os << ",\n  \"disjunction_widths\": ";
+  writeJson(os, st.width);
+  os << ",\n  \"phases\": ";
+  writeJson(os, st.phases);
+  os << "\n}\n";
+}
 
 // KCudfData
-KCudfData::KCudfData(const CudfDoc& doc, TranslatorStats& stats) {
+KCudfData::KCudfData(const CudfDoc& doc, TranslatorStats& stats,
+                     const CancelToken* ct, const CudfRequest* rq)
+  : pruned_(false), cancel_(ct), request_(rq) {
+  try {
+    build(doc, stats);
+  } catch (...) {
+    // the destructor is not called for a partially constructed object
+    release();
+    throw;
+  }
+}
+
+KCudfData::~KCudfData(void) {
+  release();
+}
+
+void KCudfData::release(void) {
+  for (auto p = packages.begin(); p != packages.end(); ++p)
+    delete p->second;
+  packages.clear();
+}
+
+void KCudfData::checkpoint(void) const {
+  if (cancel_ != NULL && cancel_->expired())
+    throw KCudfCancelled(cancel_->cancelled() ? "translation cancelled" :
+                         "translation deadline expired");
+}
+
+const CudfDoc& KCudfData::request(const CudfDoc& doc) const {
+  return request_ != NULL ? request_->request : doc;
+}
+
+bool KCudfData::installed(const CudfPackage& pi) const {
+  if (request_ != NULL && !request_->installed.empty()) {
+    auto o = request_->installed.find(std::make_pair(pi.name(), pi.version()));
+    if (o != request_->installed.end())
+      return o->second;
+  }
+  return pi.installed();
+}
+
+void KCudfData::build(const CudfDoc& doc, TranslatorStats& stats) {
+  Package::resetIds();
   /*
     first pass, get all the information about concrete packages, the
     current status of the packages is stored at this point (whether
     it is installed or not)
   */
-  processConcretePackages(doc);
-  processInstalledPackages(doc);
+  std::vector<PhaseStats>& phs = stats.phases;
+  {
+    PhaseTimer t(phs, "concrete");
+    processConcretePackages(doc);
+  }
+  {
+    PhaseTimer t(phs, "installed");
+    processInstalledPackages(doc);
+  }
   /*
     second pass: Equality constraints are parsed and added to sepcv
     data structure. This will store all the information needed to
     solve further constraints.
   */
-  processEqualityConstraints(doc);
-  processProvides(doc);
+  {
+    PhaseTimer t(phs, "equality");
+    processEqualityConstraints(doc);
+  }
+  {
+    PhaseTimer t(phs, "provides");
+    processProvides(doc);
+  }
   /// In this pass of the document we are only interested in range constraints
-  processRangeConstraints(doc);
+  {
+    PhaseTimer t(phs, "range");
+    processRangeConstraints(doc);
+  }
 
   // Flat all the disjunction packages
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    if (!p->second->isConcrete()) {
-      Disjunction *d = static_cast<Disjunction*>(p->second);
-      d->flat(packages);
+  {
+    PhaseTimer t(phs, "flatten");
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      if (!p->second->isConcrete()) {
+        checkpoint();
+        Disjunction *d = static_cast<Disjunction*>(p->second);
+        d->flat(packages);
+      }
     }
   }
 
@@ -370,71 +567,108 @@ KCudfData::KCudfData(const CudfDoc& doc, TranslatorStats& stats) {
     the tree is encoded as a disjunction that has itself as the only provider.
   */
   unsigned int compressed = 0;
-  DTNode *dt = new DTNode();
-  std::set<unsigned int> pvd;
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    if (p->second->isConcrete()) {
-      unsigned int id = p->second->getId();
-      pvd.insert(id);
-      // TODO: probably we can offer a way to add a disjunction with only one
-      // provider and avoid creating a set.
-      unsigned int nid = dt->addDisjunction(p->second->getId(),pvd);
-      (void)nid; // avoid a compiler warning when RELEASE mode
-      assert(nid == id);
-      pvd.erase(id);
-      assert(pvd.empty());
+  unsigned int zero_prov = 0;
+  std::unique_ptr<DTNode> dt(new DTNode());
+  {
+    PhaseTimer t(phs, "compress");
+    std::set<unsigned int> pvd;
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      if (p->second->isConcrete()) {
+        unsigned int id = p->second->getId();
+        pvd.insert(id);
+        // TODO: probably we can offer a way to add a disjunction with only one
+        // provider and avoid creating a set.
+        unsigned int nid = dt->addDisjunction(p->second->getId(),pvd);
+        (void)nid; // avoid a compiler warning when RELEASE mode
+        assert(nid == id);
+        pvd.erase(id);
+        assert(pvd.empty());
+      }
     }
-  }
 
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    if (!p->second->isConcrete()) {
-      Disjunction *d = static_cast<Disjunction*>(p->second);
-      unsigned int nid = dt->addDisjunction(d->getId(),d->getProviders());
-      if (nid != d->getId()) {
-        d->setForward(packages[nid]);
-        compressed++;
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      if (!p->second->isConcrete()) {
+        checkpoint();
+        Disjunction *d = static_cast<Disjunction*>(p->second);
+        unsigned int nid = dt->addDisjunction(d->getId(),d->getProviders());
+        if (nid != d->getId()) {
+          d->setForward(packages[nid]);
+          compressed++;
+        }
       }
     }
-  }
 
-  /*
-    Up to this point the install field of every package reflects its
-    state in the current installation. From now on this field and the
-    keep one will be used to encode the problem for the solver.
+    /*
+      Up to this point the install field of every package reflects its
+      state in the current installation. From now on this field and the
+      keep one will be used to encode the problem for the solver.
 
-    Before this point no function should alter the installed field of
-    the package to encode something.
-  */
+      Before this point no function should alter the installed field of
+      the package to encode something.
+    */
 
-  unsigned int zero_prov = 0;
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    if (!p->second->isConcrete()) {
-      Disjunction *d = static_cast<Disjunction*>(p->second);
-      // disjunction with only one provider are also forwarded to the provider itself
-      if (d->getProviders().size() == 1) {
-        assert(false);
-      } else if (d->getProviders().size() == 0) {
-        d->markInstall(false);
-        d->markKeep(true);
-        d->addKeepInfo("keep x zero providers");
-        zero_prov++;
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      if (!p->second->isConcrete()) {
+        Disjunction *d = static_cast<Disjunction*>(p->second);
+        // disjunction with only one provider are also forwarded to the provider itself
+        if (d->getProviders().size() == 1) {
+          assert(false);
+        } else if (d->getProviders().size() == 0) {
+          d->markInstall(false);
+          d->markKeep(true);
+          d->addKeepInfo("keep x zero providers");
+          zero_prov++;
+        }
       }
     }
   }
 
   // Fixing virtuals is something that can be only done _after_ falttening all disjunctions.
-  fixInstallVirtuals();
+  {
+    PhaseTimer t(phs, "fixInstallVirtuals");
+    fixInstallVirtuals();
+  }
   /// Process the upgrade part of the request
-  processRequest(doc,dt);
-  fixInstallVirtuals();
-  delete dt;
+  {
+    PhaseTimer t(phs, "request");
+    processRequest(doc,dt.get());
+  }
+  {
+    PhaseTimer t(phs, "fixInstallVirtuals");
+    fixInstallVirtuals();
+  }
+  // the disjunction tree is only alive during construction
+  if (stats.memory.enabled()) {
+    stats.memory.begin();
+    memory(stats.memory, dt.get());
+    stats.memory.end();
+  }
+  dt.reset();
 
-	std::cout << "Is initial installation consistent? " << (consistent() ? "yes" : "no") << std::endl;
+  bool cons;
+  {
+    PhaseTimer t(phs, "consistency");
+    cons = consistent();
+  }
+	std::cout << "Is initial installation consistent? " << (cons ? "yes" : "no") << std::endl;
   
   unsigned int disj = 0;
   for (auto p = packages.begin(); p != packages.end(); ++p) {
     if (!p->second->isConcrete()) {
       disj++;
+      const Disjunction *d = static_cast<const Disjunction*>(p->second);
+      unsigned int fl = d->forwardLength();
+      if (stats.fwd.size() <= fl)
+        stats.fwd.resize(fl + 1, 0);
+      stats.fwd[fl]++;
+      if (fl > 0)
+        continue;
+      unsigned int w = 0;
+      for (size_t n = d->getProviders().size(); n > 0; n >>= 1)
+        w++;
+      if (stats.width.size() <= w)
+        stats.width.resize(w + 1, 0);
+      stats.width[w]++;
     }  
 	}
 
@@ -443,6 +677,11 @@ KCudfData::KCudfData(const CudfDoc& doc, TranslatorStats& stats) {
   stats.rd = disj;
   stats.ed = compressed;
   stats.zp = zero_prov;
+  stats.pkgs = packages.size();
+  stats.constv = constv.size();
+  stats.specv = specv.size();
+  for (auto& v : specv)
+    stats.specv_versions += v.second.size();
   
   // fill in bigPackages
   for (auto p = packages.begin(); p != packages.end(); ++p) {
@@ -459,11 +698,17 @@ KCudfData::KCudfData(const CudfDoc& doc, TranslatorStats& stats) {
       //std::cout << "Marked install " << pk->name() << " " << d->getId() << std::endl;
     }
   }
-   
+
+  if (stats.memory.enabled()) {
+    stats.memory.begin();
+    memory(stats.memory);
+    stats.memory.end();
+  }
 }
 
 void KCudfData::processConcretePackages(const CudfDoc& doc) {
   for (const CudfPackage& pi : doc.getPackages()) {
+    checkpoint();
     //std::cerr << "reaing info about package " << pi->name() << std::endl;
 
     /**
@@ -474,7 +719,7 @@ void KCudfData::processConcretePackages(const CudfDoc& doc) {
        at this time for it is the concrete package.
     */
     // create the concrete package and register it
-    SelfPackage *p = new SelfPackage(pi.name(),pi.installed(),pi.version());
+    SelfPackage *p = new SelfPackage(pi.name(),installed(pi),pi.version());
     // the package should not exist
     if (concrete.count(pi.name()) > 0) {
       assert(concrete[pi.name()].count(pi.version()) == 0);
@@ -506,7 +751,7 @@ void KCudfData::processConcretePackages(const CudfDoc& doc) {
     specv[pi.name()][pi.version()] = d->getId();
     
     // the following code brings support for the paranoid optimization criteria.
-    if (pi.installed()) {
+    if (installed(pi)) {
       // if the package is installed we create a pkgname-pvany disjunction with the
       // package as a provider. This disjunction will represent the global package
       // and is installed if at least one of the corresponding package units are
@@ -549,6 +794,7 @@ void KCudfData::processInstalledPackages(const CudfDoc& doc) {
 void KCudfData::processEqualityConstraints(const CudfDoc& doc) {
   // for the packages stated in the universe
   for (const CudfPackage& pi : doc.getPackages()) {
+    checkpoint();
     // the id of the current package
     unsigned int cpi_id = concrete[pi.name()][pi.version()];
     unsigned int pi_id = specv[pi.name()][pi.version()];
@@ -556,7 +802,12 @@ void KCudfData::processEqualityConstraints(const CudfDoc& doc) {
     // process the keep version feature of the packages that have it.
     if (pi.keep() == KP_VERSION) {
       std::cerr << "Keep version in package " << pi << std::endl;
-      assert(pi.installed()); // todo: convert to an exception
+      if (!installed(pi)) {
+        std::ostringstream ss;
+        ss << "package " << pi.name() << " = " << pi.version()
+           << " keeps its version but is not installed";
+        throw KCudfFailure(ss.str().c_str());
+      }
       Package *p = packages[pi_id];
       p->markInstall(true);
       p->markKeep(true);
@@ -615,14 +866,14 @@ void KCudfData::processEqualityConstraints(const CudfDoc& doc) {
     trying to install or upgrade it will result in a failure.
   */
 
-  for (const Vpkg& vpk : doc.reqToInstall()) {
+  for (const Vpkg& vpk : request(doc).reqToInstall()) {
     if (vpk.getRel() == ROP_EQ) {
       std::cerr << "Requested to install (EQ) " << vpk << std::endl;
       addDisjunction(vpk.getName(),vpk.getVersion());
     }
   }
 
-  for (const Vpkg& vpk : doc.reqToRemove()) {
+  for (const Vpkg& vpk : request(doc).reqToRemove()) {
     if (vpk.getRel() == ROP_EQ) {
       std::cerr << "Requested to remove (EQ) " << vpk << std::endl;
       addDisjunction(vpk.getName(), vpk.getVersion());
@@ -632,6 +883,7 @@ void KCudfData::processEqualityConstraints(const CudfDoc& doc) {
 
 void KCudfData::processProvides(const CudfDoc& doc) {
   for (const CudfPackage& pi : doc.getPackages()) {
+    checkpoint();
     // the id of the current package
     unsigned int cpi_id = concrete[pi.name()][pi.version()];
     // the package pointer corresponding to the current package
@@ -671,6 +923,7 @@ void KCudfData::processProvides(const CudfDoc& doc) {
 
 void KCudfData::processRangeConstraints(const CudfDoc& doc) {
   for (const CudfPackage& pi : doc.getPackages()) {
+    checkpoint();
     /*
       for the current package we have several nodes representing it in the graph,
       the first one is a node representing the concrete package itself (cpi_id) and
@@ -777,13 +1030,13 @@ void KCudfData::processRangeConstraints(const CudfDoc& doc) {
     }
 
     // for the packages stated in the request
-    for (const Vpkg& vpk: doc.reqToInstall())
+    for (const Vpkg& vpk: request(doc).reqToInstall())
       if (vpk.getRel() != ROP_EQ) {
         //std::cerr << "Requested to install (RANGE) " << *vpk << std::endl;
         getDisjunction(vpk);
       }
 
-    for (const Vpkg& vpk : doc.reqToRemove()) 
+    for (const Vpkg& vpk : request(doc).reqToRemove()) 
       if (vpk.getRel() != ROP_EQ) {
         //std::cerr << "Requested to remove (RANGE) " << *vpk << std::endl;
         getDisjunction(vpk);
@@ -804,6 +1057,7 @@ void KCudfData::fixInstallVirtuals(void) {
 }
 
 void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
+  checkpoint();
   std::set<Package*> toInstall;
   std::set<Package*> toUninstall;
 
@@ -887,7 +1141,7 @@ void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
   */
 
   // Process the upgrade
-  for (const Vpkg& vpk: doc.reqToUpgrade()) {
+  for (const Vpkg& vpk: request(doc).reqToUpgrade()) {
     std::cerr << "Requested to upgrade constraint " << vpk << std::endl;
     std::stringstream name; name << vpk.serialize() << "-req-upg";
     Disjunction *upg = new Disjunction(name.str().c_str());
@@ -935,8 +1189,8 @@ void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
           toUninstall.insert(p);
         }
       }
-      // 3- Create a conflict among all the packages in range (at most one should be installed at the end)
-      pairwiseConflicting(range);
+      // 3- At most one of the packages in range should be installed at the end
+      atMostOne(range);
       // 4- create a disjunction with the elements in range as providers (if it
       //    does not exist yet
       Disjunction *tmp = new Disjunction("temporal");
@@ -953,6 +1207,7 @@ void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
       if (d_id != tmp->getId()) {
         std::cerr << "upgrade: Already existent disjunction " << d_id << std::endl;
         upg->addProvider(d_id);
+        delete tmp;
       } else {
         std::cerr << "upgrade: Newly existent disjunction" << std::endl;
         packages[tmp->getId()] = tmp;
@@ -970,7 +1225,7 @@ void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
     by range constraints). Then the only thing remaining is to mark those
     packages as keep install.
   */
-  for (const Vpkg& vpk: doc.reqToInstall()) {
+  for (const Vpkg& vpk: request(doc).reqToInstall()) {
     if (vpk.getRel() == ROP_EQ) {
       assert(specv.count(vpk.getName()) > 0);
       Package *p = packages[specv[vpk.getName()][vpk.getVersion()]];
@@ -991,12 +1246,18 @@ void KCudfData::processRequest(const CudfDoc& doc, DTNode *dsj ) {
   }
 
   // Process the removals
-  for (const Vpkg& vpk: doc.reqToRemove()) {
+  for (const Vpkg& vpk: request(doc).reqToRemove()) {
     if (vpk.getRel() == ROP_EQ) {
       assert(specv.count(vpk.getName()) > 0);
       toUninstall.insert(packages[specv[vpk.getName()][vpk.getVersion()]]);
     } else {
-      const std::string& name = vpk.serialize();
+      // same name as the disjunction created by getDisjunction
+      std::stringstream ss;
+      if (vpk.versioned())
+        ss << vpk.serialize();
+      else
+        ss << vpk.getName() << "-pvany";
+      const std::string& name = ss.str();
       assert(constv.count(name) > 0);
       toUninstall.insert(packages[constv[name]]);
     }
@@ -1152,11 +1413,9 @@ void KCudfData::solveConstraint(const Vpkg& c, std::vector<unsigned int>& pkgs)
   }
 }
 
-void KCudfData::pairwiseConflicting(const std::set<unsigned int>& s) {
-  for (auto p = s.begin(); p != s.end(); ++p)
-    for (auto q = s.begin(); q != s.end(); ++q)
-      if (*p != *q)
-        packages[*p]->addConflict(*q);
+void KCudfData::atMostOne(const std::set<unsigned int>& s) {
+  if (s.size() > 1)
+    groups_.push_back(std::vector<unsigned int>(s.begin(), s.end()));
 }
 
 const std::map<unsigned int,Package*>&
@@ -1169,6 +1428,113 @@ KCudfData::bigPackages(void) const {
   return bigPackages_;
 }
 
+const std::vector<std::vector<unsigned int> >&
+KCudfData::groups(void) const {
+  return groups_;
+}
+
+void KCudfData::memory(MemoryReport& r, const DTNode* dt) const {
+  r.add("KCudfData::packages", packages.size(), heapBytes(packages));
+  for (auto p = packages.begin(); p != packages.end(); ++p)
+    p->second->memory(r);
+
+  // name -> version -> id maps
+  auto versions = [&r](const char* n, const std::map<std::string,std::map<int,int> >& m) {
+    size_t c = 0, b = heapBytes(m);
+    for (auto v = m.begin(); v != m.end(); ++v) {
+      c += v->second.size();
+      b += heapBytes(v->first) + heapBytes(v->second);
+    }
+    r.add(n, c, b);
+  };
+  versions("KCudfData::concrete", concrete);
+  versions("KCudfData::specv", specv);
+
+  size_t b = heapBytes(constv);
+  for (auto c = constv.begin(); c != constv.end(); ++c)
+    b += heapBytes(c->first);
+  r.add("KCudfData::constv", constv.size(), b);
+
+  size_t c = 0;
+  b = heapBytes(groups_);
+  for (const std::vector<unsigned int>& g : groups_) {
+    c += g.size();
+    b += heapBytes(g);
+  }
+  r.add("KCudfData::groups", c, b);
+
+  if (dt != NULL)
+    dt->memory(r);
+}
+
+void KCudfData::prune(TranslatorStats& stats, bool paranoid) {
+  /*
+    Disjunctions know their providers but packages do not know the
+    disjunctions they provide, this is collected first together with the
+    roots.
+  */
+  std::map<unsigned int, std::vector<unsigned int> > provides;
+  std::vector<unsigned int> todo;
+  unsigned int total = 0;
+  cone_.clear();
+  for (auto p = packages.begin(); p != packages.end(); ++p) {
+    Package *rp = p->second;
+    if (p->first != rp->getId())
+      continue;
+    total++;
+    if (rp->markedInstall() && cone_.insert(rp->getId()).second)
+      todo.push_back(rp->getId());
+    if (!rp->isConcrete())
+      for (unsigned int q : static_cast<Disjunction*>(rp)->getProviders())
+        provides[packages.at(q)->getId()].push_back(rp->getId());
+  }
+  if (paranoid) {
+    // the other versions of the installed families are part of the search
+    std::set<std::string> families;
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      Package *rp = p->second;
+      if (p->first == rp->getId() && rp->isConcrete() && rp->markedInstall())
+        families.insert(static_cast<SelfPackage*>(rp)->name());
+    }
+    for (auto p = packages.begin(); p != packages.end(); ++p) {
+      Package *rp = p->second;
+      if (p->first == rp->getId() && rp->isConcrete() && !rp->markedKeep() &&
+          families.count(static_cast<SelfPackage*>(rp)->name()) > 0 &&
+          cone_.insert(rp->getId()).second)
+        todo.push_back(rp->getId());
+    }
+  }
+
+  auto visit = [&](unsigned int q) {
+    unsigned int id = packages.at(q)->getId();
+    if (cone_.insert(id).second)
+      todo.push_back(id);
+  };
+  while (!todo.empty()) {
+    unsigned int p = todo.back();
+    todo.pop_back();
+    Package *rp = packages.at(p);
+    // a package kept uninstalled constrains nothing but itself
+    if (rp->markedKeep() && !rp->markedInstall())
+      continue;
+    for (unsigned int q : rp->getDependencies())
+      visit(q);
+    auto pv = provides.find(p);
+    if (pv != provides.end())
+      for (unsigned int q : pv->second)
+        visit(q);
+    if (!rp->isConcrete())
+      for (unsigned int q : static_cast<Disjunction*>(rp)->getProviders())
+        visit(q);
+  }
+  pruned_ = true;
+  stats.pruned = total - cone_.size();
+}
+
+bool KCudfData::relevant(unsigned int p) const {
+  return !pruned_ || cone_.count(p) > 0;
+}
+
 const std::vector<int>&
 KCudfData::crtPackages(void) const {
   //return crtPackages_;
@@ -1179,6 +1545,19 @@ bool
 KCudfData::consistent(void) const {
 	unsigned int inst = 0;
 	std::set<unsigned int> done;
+
+  /*
+    A package of an at-most-one group conflicts with every other member of the
+    group, count the members with installed providers to check it.
+  */
+  std::map<unsigned int, std::vector<unsigned int> > member;
+  std::vector<unsigned int> active(groups_.size(), 0);
+  for (unsigned int g = 0; g < groups_.size(); g++)
+    for (unsigned int q : groups_[g]) {
+      member[packages.at(q)->getId()].push_back(g);
+      if (installedProviders(q) != 0)
+        active[g]++;
+    }
 	
   for ( auto p = packages.begin(); p != packages.end(); ++p) {
     Package *pi = p->second;
@@ -1213,6 +1592,12 @@ KCudfData::consistent(void) const {
               cnf_cons = false;
             }		
           }
+          auto m = member.find(pk->getId());
+          if (m != member.end())
+            for (unsigned int g : m->second)
+              // pk is installed so it is one of the active members
+              if (active[g] > 1)
+                cnf_cons = false;
           if (cnf_cons) {
             conPackages_.push_back(pk->getId());
           }				
@@ -1350,6 +1735,12 @@ void DTNode::addChild(unsigned int u, DTNode* c) {
   children[u] = c;
 }
 
+void DTNode::memory(MemoryReport& r) const {
+  r.add("DTNode trie", 1, heapBlock(sizeof(DTNode)) + heapBytes(children));
+  for (auto n = children.begin(); n != children.end(); ++n)
+    n->second->memory(r);
+}
+
 unsigned int DTNode::addDisjunction(unsigned int id, const std::set<unsigned int>& pvds) {
 
   std::set<unsigned int> e(pvds);
@@ -1381,177 +1772,131 @@ unsigned int DTNode::addDisjunction(unsigned int id, const std::set<unsigned int
  * KCudfTranslator
  */
 
-KCudfTranslator::KCudfTranslator(const CudfDoc& d)
-  : doc(d), st(), data(doc,st) {}
+KCudfTranslator::KCudfTranslator(const CudfDoc& d, bool memory)
+  : doc(d), st(memory), data(doc,st), cancel(NULL) {}
 
-const TranslatorStats& KCudfTranslator::stats(void) const {
-  return st;
-}
-
-void KCudfTranslator::writePackages(KCudfWriter& wrt, KCudfInfoWriter& inf, bool debug) {
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
-  // concrete packages
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (pi->isConcrete() && done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      assert(rp->isConcrete());
-      SelfPackage *pk = static_cast<SelfPackage*> (rp);
-      std::ostringstream desc;
-      desc << pk->getVersion() << pk->name();
-      wrt.package(pk->getId(), pk->markedKeep(), pk->markedInstall(), desc.str().c_str());
-      inf.package(pk->getId(), pk->getVersion(), pk->name().c_str());
-      done.insert(rp->getId());
-    }
+KCudfTranslator::KCudfTranslator(const CudfDoc& d, bool memory, bool prune,
+                                 const CancelToken* ct, const CudfRequest* rq,
+                                 bool paranoid)
+  : doc(d), st(memory), data(doc,st,ct,rq), cancel(ct) {
+  if (prune) {
+    PhaseTimer t(st.phases, "prune");
+    data.prune(st, paranoid);
   }
-  // artificial packages
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
+}
 
-    if (!pi->isConcrete() && done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      const char *info = debug ? rp->getInfo() : "";
-      wrt.package(rp->getId(), rp->markedKeep(), rp->markedInstall(), info);
-      // TODO: this can clash ith a real package version, fix this.
-      inf.package(rp->getId(), 999, info);
-      done.insert(rp->getId());
-    }
-  }
+const TranslatorStats& KCudfTranslator::stats(void) const {
+  return st;
 }
 
-void KCudfTranslator::writeConcreteSelfProvided(KCudfWriter& wrt, bool debug) {
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
-  // single disjunctions corresponding to concrete packages
+void KCudfTranslator::collectDependencies(Section& s, bool debug) const {
+  KCUDF_TRACE_SCOPE("collectDependencies");
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
   for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (pi->isConcrete() && done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      assert(rp->isConcrete());
-      SelfPackage *pk = static_cast<SelfPackage*> (rp);
-      std::ostringstream desc;
+    if (!emitted(*p)) continue;
+    Package *rp = p->second;
+    unsigned int id = rp->getId();
+    for  (unsigned int d: rp->getDependencies()) {
+      Package *p2 = packages.at(d);
+      // only packages kept uninstalled depend on packages out of the cone
+      if (!data.relevant(p2->getId())) continue;
+      std::string desc;
       if (debug) {
-        desc << pk->getVersion() << pk->name() << "-self";
+        desc.append(rp->getInfo()).append(" -> ").append(p2->getInfo());
       }
-      wrt.provides(pk->getId(), pk->getId(), desc.str().c_str());
-      done.insert(rp->getId());
+      s.add(id, p2->getId(), std::move(desc), debug);
     }
   }
 }
 
-void KCudfTranslator::writeDependencies(KCudfWriter& wrt, bool debug) {
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
+void KCudfTranslator::collectConflicts(Section& s, bool debug) const {
+  KCUDF_TRACE_SCOPE("collectConflicts");
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
   for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      unsigned int id = rp->getId();
-      for  (unsigned int d: rp->getDependencies()) {
-        std::ostringstream desc;
-        Package *p2 = packages.at(d);
-        if (debug) {
-          desc << rp->getInfo() << " -> " << p2->getInfo();
-        }
-        wrt.dependency(id, p2->getId(), desc.str().c_str());
+    if (!emitted(*p)) continue;
+    Package *rp = p->second;
+    unsigned int id = rp->getId();
+    for (unsigned int d: rp->getConflicts()) {
+      Package *p2 = packages.at(d);
+      if (!data.relevant(p2->getId())) continue;
+      std::string desc;
+      /*
+        The conflict relation is undirected: the smaller id is put first so
+        that both orientations of the same conflict become equal.
+      */
+      if(id < p2->getId()) {
+        if (debug)
+          desc.append(rp->getInfo()).append(" -- ").append(p2->getInfo());
+        s.add(id, p2->getId(), std::move(desc), debug);
+      } else {
+        if (debug)
+          desc.append(p2->getInfo()).append(" -- ").append(rp->getInfo());
+        s.add(p2->getId(), id, std::move(desc), debug);
       }
-      done.insert(rp->getId());
     }
   }
-}
-
-void KCudfTranslator::writeConflicts(KCudfWriter& wrt, bool debug) {
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
-  for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      unsigned int id = rp->getId();
-      for (unsigned int d: rp->getConflicts()) {
-        std::ostringstream desc;
-        Package *p2 = packages.at(d);
-        /*
-          Just to make the output easy to debug, the smaller id is put first. This
-          does not have impact on the conflict relation since it is undirected.
-        */
-        if(id < p2->getId()) {
-          if (debug)
-            desc << rp->getInfo() << " -- " << p2->getInfo();
-          wrt.conflict(id, p2->getId(), desc.str().c_str());
-        } else {
-          if (debug)
-            desc << p2->getInfo() << " -- " << rp->getInfo();
-          wrt.conflict(p2->getId(), id, desc.str().c_str());
-        }
-      }
-      done.insert(rp->getId());
-    }
+  // keep a single occurrence of every conflict
+  std::vector<relation_t>& rs = s.rels;
+  if (!debug) {
+    std::sort(rs.begin(), rs.end());
+    rs.erase(std::unique(rs.begin(), rs.end()), rs.end());
+    return;
   }
-}
-
-void KCudfTranslator::writeProvides(KCudfWriter& wrt, bool debug) {
+  // the descriptions follow the relations through a sorted permutation
+  std::vector<size_t> ord(rs.size());
+  std::iota(ord.begin(), ord.end(), 0);
+  std::stable_sort(ord.begin(), ord.end(),
+                   [&rs](size_t a, size_t b) { return rs[a] < rs[b]; });
+  Section u;
+  for (size_t i : ord)
+    if (u.rels.empty() || u.rels.back() != rs[i])
+      u.add(rs[i].first, rs[i].second, std::move(s.descs[i]), true);
+  s = std::move(u);
+}
+
+void KCudfTranslator::collectProvides(Section& s, bool debug) const {
+  KCUDF_TRACE_SCOPE("collectProvides");
   /**
-   * This procedure will call the writer in the following way:
-   * wrt.provided(I J C)
+   * Every collected relation <I, J, C> will be passed to the writer as
+   * wrt.provides(I J C) followed by wrt.dependency(I J C).
    * Where I and J are numeric packages identifiers and C is a possible empty string
    * with meaningless information.
    *
    * The semantic is: "Package I _Provides_ J"
    */
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
   for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (!pi->isConcrete() && done.count(pi_id) == 0) {
-      Disjunction *rp = static_cast<Disjunction*>(packages.at(pi->getId()));
-      unsigned int id = rp->getId();
-      for (unsigned int d: rp->getProviders()) {
-        std::ostringstream desc;
-        Package *p2 = packages.at(d);
-        if (debug)
-          desc << rp->getInfo() << " -> " << p2->getInfo() ;
-        wrt.provides(p2->getId(), id, desc.str().c_str());
-        wrt.dependency(p2->getId(), id, desc.str().c_str());
-      }
-      done.insert(rp->getId());
+    if (!emitted(*p) || p->second->isConcrete()) continue;
+    Disjunction *rp = static_cast<Disjunction*>(p->second);
+    unsigned int id = rp->getId();
+    for (unsigned int d: rp->getProviders()) {
+      Package *p2 = packages.at(d);
+      if (!data.relevant(p2->getId())) continue;
+      std::string desc;
+      if (debug)
+        desc.append(rp->getInfo()).append(" -> ").append(p2->getInfo());
+      s.add(p2->getId(), id, std::move(desc), debug);
     }
   }
 }
 
 void KCudfTranslator::translate(KCudfWriter& wrt, KCudfInfoWriter& inf, bool dbg) {
-  writePackages(wrt, inf, dbg);
-  writeDependencies(wrt, dbg);
-  writeConflicts(wrt, dbg);
-  writeConcreteSelfProvided(wrt, dbg);
-  writeProvides(wrt, dbg);
+  translate<KCudfWriter,KCudfInfoWriter>(wrt, inf, dbg);
 }
 
 void KCudfTranslator::
 extraParanoid(std::vector<int>& search) const {
   
   std::map<std::string,boost::tuple<bool,std::vector<int> > > families;
-  std::set<unsigned int> done;
-  auto packages = data.getPackages();
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
   for (auto p = packages.begin(); p != packages.end(); ++p) {
-    Package *pi = p->second;
-    unsigned int pi_id = pi->getId();
-    if (pi->isConcrete() && done.count(pi_id) == 0) {
-      Package *rp = packages.at(pi->getId());
-      SelfPackage *pk = static_cast<SelfPackage*> (rp);
+    if (emitted(*p) && p->second->isConcrete()) {
+      SelfPackage *pk = static_cast<SelfPackage*> (p->second);
       families[pk->name()].get<1>().push_back(pk->getId());
       if (pk->markedInstall()) {
         // one of the familiy is marked
         families[pk->name()].get<0>() = true;
       }
-      done.insert(rp->getId());
     }
   }
   
@@ -1596,85 +1941,53 @@ void KCudfTranslator::writeParanoid(std::ostream& big) const {
 }
 
 void read(std::istream& input, KCudfWriter& wrt) {
-  using namespace std;
-
-  if (input.fail())
-    throw FailedStream("unable to open stream for reading");
-
-  char inst, keep;
-  unsigned int id, id2;
-  unsigned int ln = 0; // line number
-
-  std::string line;
-  while(input.good()) {
-    std::getline(input, line);
-    ln++;
-    if (line.empty()) continue;
-    char t = line[0];
-    line.erase(0, 1);
-    stringstream ss(line);
-    switch (t) {
-    case 'P':
-      ss >> id; ss >> keep; ss >> inst;
-      wrt.package(id,
-                  (keep == 'K' ? true : false),
-                  (inst == 'I' ? true : false), "");
-      // Make explicit a self dependency for all the packages
-      wrt.dependency(id, id, "self-dep");
-      break;
-    case 'D':
-      ss >> id; ss >> id2;
-      wrt.dependency(id, id2, "");
-      break;
-    case 'C':
-      ss >> id; ss >> id2;
-      wrt.conflict(id, id2, "");
-      break;
-    case 'R':
-      ss >> id; ss >> id2;
-      wrt.provides(id, id2, "");
-      break;
-    case '#':
-      // just to allow comments starting with #
-      break;
-    default:
-      std::ostringstream ss;
-      ss << "Unknown statement found while reading line: ..." << line
-          << std::endl
-          << " at line: " << ln;
-      throw KCudfReaderInvalidStatement(ss.str().c_str());
-      break;
-      }
-    }
+  read<KCudfWriter>(input, wrt);
 }
 
 void readInfo(const char* info,
               std::map<std::string, std::map<unsigned int, unsigned int> >& m) {
   // TODO: change this to use the next function
   using namespace std;
-  std::string name;
+  if (KCudfInfoIndex::isIndex(info)) {
+    KCudfInfoIndex idx(info);
+    for (unsigned int i = 0; i < idx.size(); i++)
+      if (idx.kind(i) == IK_CONCRETE)
+        m[idx.name(i)][idx.version(i)] = i;
+    return;
+  }
   unsigned int id, version;
 
-  ifstream file(info);
+  InputFile file(info);
   std::string l;
   while(std::getline(file, l)) {
+    // artificial packages may have no name
+    std::string name;
     stringstream ss(l);
     ss >> id; ss >> version; ss >> name;
-    m[name][version] = id;
+    if (version != 0)
+      m[name][version] = id;
   }
 }
 
 void readInfo(const char* info, KCudfInfoWriter& wrt) {
   using namespace std;
-  std::string name;
+  if (KCudfInfoIndex::isIndex(info)) {
+    KCudfInfoIndex(info).read(wrt);
+    return;
+  }
   unsigned int id, version;
 
-  ifstream file(info);
+  InputFile file(info);
   std::string l;
   while(std::getline(file, l)) {
+    // artificial packages may have no name
+    std::string name;
     stringstream ss(l);
     ss >> id; ss >> version; ss >> name;
-    wrt.package(id, version, name.c_str());
+    if (version == 0)
+      wrt.artificial(id, name.c_str());
+    else
+      wrt.package(id, version, name.c_str());
   }
 }
 
@@ -1683,23 +1996,73 @@ void readInfo(const char* info, KCudfInfoWriter& wrt) {
  */
 CudfUpdater::
 CudfUpdater(CudfDoc& doc, 
-            std::map<std::string,std::map<unsigned int, unsigned int> >& m) 
+            const std::map<std::string,std::map<unsigned int, unsigned int> >& m) 
 : changed(0) {
+  for (auto pi = doc.pkg_mbegin(); pi != doc.pkg_mend(); ++pi) {
+    auto n = m.find(pi->name());
+    if (n == m.end()) continue;
+    auto v = n->second.find(pi->version());
+    if (v != n->second.end())
+      associate(v->second, &(*pi));
+  }
+}
+
+namespace {
+  /// Info writer passing the concrete packages to a callback
+  class UpdaterInfo : public KCudfInfoWriter {
+  private:
+    /// Callback for every concrete package
+    std::function<void(unsigned int, unsigned int, const char*)> pkg;
+  public:
+    UpdaterInfo(std::function<void(unsigned int, unsigned int, const char*)> f)
+      : pkg(f) {}
+    void package(unsigned int id, unsigned int version, const char* name) {
+      pkg(id, version, name);
+    }
+    void artificial(unsigned int, const char*) {}
+  };
+}
+
+CudfUpdater::CudfUpdater(CudfDoc& doc, const char* info)
+  : changed(0) {
   for (auto pi = doc.pkg_mbegin(); pi != doc.pkg_mend(); ++pi)
-    status[m[pi->name()][pi->version()]] = &(*pi);
+    byName[pi->name()].push_back(&(*pi));
+  UpdaterInfo ui([this](unsigned int id, unsigned int version, const char* name) {
+      CudfPackage* pk = find(name, version);
+      if (pk != NULL)
+        associate(id, pk);
+    });
+  readInfo(info, ui);
+  byName.clear();
+}
+
+CudfUpdater::~CudfUpdater(void) {}
+
+CudfPackage* CudfUpdater::find(const char* name, unsigned int version) const {
+  auto n = byName.find(name);
+  if (n == byName.end())
+    return NULL;
+  for (CudfPackage* pk : n->second)
+    if (static_cast<unsigned int>(pk->version()) == version)
+      return pk;
+  return NULL;
+}
+
+void CudfUpdater::associate(unsigned int id, CudfPackage* pk) {
+  if (status.size() <= id)
+    status.resize(id + 1, NULL);
+  status[id] = pk;
 }
 
-void CudfUpdater::package(unsigned int id, bool keep, bool install, const char*) {
-  //std::cerr << "Updating " << id << " " << (install ? "true" : "false") << std::endl;
-  if(status.count(id) > 0) {
-    CudfPackage * pk = status[id];
+void CudfUpdater::package(unsigned int id, bool, bool install, const char*) {
+  CudfPackage * pk = id < status.size() ? status[id] : NULL;
+  if (pk != NULL) {
     if (pk->installed() != install) {
       changed++;
     }
     pk->install(install);
-  } else {
-    //std::cerr << "Assuming virtual: " << id << std::endl;
   }
+  // otherwise the package is artificial
 }
 
 void CudfUpdater::dependency(unsigned int, unsigned int, const char*) {}
@@ -1708,17 +2071,78 @@ void CudfUpdater::conflict(unsigned int, unsigned int, const char*) {}
 
 void CudfUpdater::provides(unsigned int, unsigned int, const char*) {}
 
+void CudfUpdater::atMostOne(const std::vector<unsigned int>&, const char*) {}
+
 unsigned int CudfUpdater::stats(void) const {
   return changed;
 }
 
-void update(CudfDoc& doc, const char* info, std::ifstream& kcudf0, std::ifstream& kcudf1) {
-  std::map<std::string, std::map<unsigned int, unsigned int> > m;
-  readInfo(info, m);
-  CudfUpdater up(doc,m);
+namespace {
+  /**
+   * \brief Reads the packages of the solution of a search part from \a is
+   * into \a up, translating its identifiers back with the table in file \a
+   * renumber and expanding the classes in file \a merge (when they are not
+   * NULL).
+   */
+  void readSolution(std::istream& is, CudfUpdater& up, const char* renumber,
+                    const char* merge) {
+    KCudfMerging mg;
+    if (merge != NULL) {
+      InputFile ms(merge);
+      if (!ms)
+        throw FailedStream("unable to read the merged classes");
+      mg.read(ms);
+    }
+    KCudfRenumbering rn;
+    if (renumber != NULL) {
+      InputFile rs(renumber);
+      if (!rs)
+        throw FailedStream("unable to read the renumbering table");
+      rn.read(rs);
+    }
+    // the classes hold the identifiers before the renumbering
+    KCudfExpandWriter<CudfUpdater> eup(up, mg);
+    KCudfWriter& mw = merge != NULL ? static_cast<KCudfWriter&>(eup) : up;
+    KCudfRenumberWriter<KCudfWriter> rup(mw, rn, true);
+    readPackages(is, renumber != NULL ? static_cast<KCudfWriter&>(rup) : mw);
+  }
+}
+
+void update(CudfDoc& doc, const char* info, std::istream& kcudf0, std::istream& kcudf1,
+            const char* renumber, const char* merge) {
+  KCUDF_TRACE_SCOPE("update");
+  CudfUpdater up(doc, info);
+  readPackages(kcudf0, up);
+  readSolution(kcudf1, up, renumber, merge);
+}
 
-  read(kcudf0,up);
-  read(kcudf1,up);
+void update(CudfDoc& doc, const char* info, const char* kcudf0, const char* kcudf1,
+            const char* renumber, const char* merge) {
+  InputFile is0(kcudf0);
+  InputFile is1(kcudf1);
+  update(doc, info, is0, is1, renumber, merge);
+}
+
+void format(CudfDoc& doc, const char* info, const char* easy,
+            std::istream& solved, const char* renumber, const char* merge) {
+  KCUDF_TRACE_SCOPE("format");
+  CudfUpdater up(doc, info);
+  InputFile is(easy);
+  readPackages(is, up);
+  readSolution(solved, up, renumber, merge);
+}
+
+void format(CudfDoc& doc, const char* info, const char* easy,
+            const char* solved, const char* renumber, const char* merge) {
+  if (solved != NULL) {
+    InputFile is(solved);
+    format(doc, info, easy, is, renumber, merge);
+    return;
+  }
+  KCUDF_TRACE_SCOPE("format");
+  CudfUpdater up(doc, info);
+  InputFile is(easy);
+  readPackages(is, up);
 }
 
 /*
@@ -1762,6 +2186,14 @@ void KCudfWriter::conflict(unsigned int, unsigned int, const char*) {}
 
 void KCudfWriter::provides(unsigned int, unsigned int, const char*) {}
 
+void KCudfWriter::unprovided(unsigned int) {}
+
+void KCudfWriter::atMostOne(const std::vector<unsigned int>& g, const char* desc) {
+  for (auto p = g.begin(); p != g.end(); ++p)
+    for (auto q = p + 1; q != g.end(); ++q)
+      conflict(*p, *q, desc);
+}
+
 /*
  * KCudfInfoWriter
  */
@@ -1770,3 +2202,7 @@ KCudfInfoWriter::KCudfInfoWriter(void) {}
 KCudfInfoWriter::~KCudfInfoWriter(void) {}
 
 void KCudfInfoWriter::package(unsigned int, unsigned int, const char*) {}
+
+void KCudfInfoWriter::artificial(unsigned int id, const char* desc) {
+  package(id, 0, desc);
+}
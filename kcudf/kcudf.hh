@@ -43,8 +43,21 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <tuple>
+#include <sstream>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+#include <chrono>
+#include <atomic>
 
 #include <kcudf/cudf.hh>
+#include <kcudf/memory.hh>
+#include <kcudf/trace.hh>
+#include <kcudf/zstream.hh>
 
 
 #include <list> // TODO: should be replaced by a vector!
@@ -69,8 +82,8 @@ private:
   std::set<unsigned int> dependencies;
   /// Functionality provided by this package
   std::set<unsigned int> provides;
-  /// Used to create a consecutive id for each package
-  static unsigned int next_id;
+  /// Used to create a consecutive id for each package, per thread
+  static thread_local unsigned int next_id;
 protected:
   /// Information about the package
   std::string info;
@@ -81,6 +94,14 @@ public:
   Package(bool inst, int v);
   /// Destructor
   virtual ~Package(void);
+  /**
+   * \brief Restarts from 0 the identifiers of the packages created by the
+   * calling thread.
+   *
+   * Every translation does it, so the identifiers of a translation do not
+   * depend on the ones that ran before it in the same process.
+   */
+  static void resetIds(void);
   /// Adds \a p as a conflict to this package
   virtual void addConflict(unsigned int p);
   /// Adds \a p as a dependency of this package
@@ -113,6 +134,8 @@ public:
   void addInfo(const char* ninf);
   /// Add keep info to the package
   void addKeepInfo(const char* ninf);
+  /// Adds the memory used by the package to report \a r
+  virtual void memory(MemoryReport& r) const;
 };
 
 /// Output package to \a o
@@ -177,6 +200,8 @@ public:
   bool isFlat(void) const;
   /// Set the current disjunction to package p
   void setForward(Package *p);
+  /// Number of forwards to follow to reach the package representing this
+  unsigned int forwardLength(void) const;
   /// Mark a package as install or not
   virtual void markInstall(bool st);
   /// Tests if the package is marked or not as install
@@ -185,7 +210,8 @@ public:
   virtual void markKeep(bool st);
   /// Tests if the package is marked or not as install
   virtual bool markedKeep(void) const;
-
+  /// Adds the memory used by the disjunction to report \a r
+  virtual void memory(MemoryReport& r) const;
 };
 
 /**
@@ -203,6 +229,91 @@ public:
   bool isConcrete(void) const;
   /// Return the name of the package
   const std::string& name(void) const;
+  /// Adds the memory used by the package to report \a r
+  virtual void memory(MemoryReport& r) const;
+};
+
+/**
+ * \brief Wall time and allocations of a phase of some process.
+ */
+class PhaseStats {
+public:
+  /**
+   * \brief Function returning the number of allocations done so far by the
+   * application.
+   *
+   * The library does not count allocations by itself: applications that
+   * replace the global allocation functions to count them can set this
+   * function and allocations will be reported for every phase.
+   */
+  static unsigned long long (*allocations)(void);
+  /// Name of the phase
+  std::string name;
+  /// Number of times the phase was run
+  unsigned int runs;
+  /// Wall time of all the runs in seconds
+  double secs;
+  /// Allocations done by all the runs (zero if \a allocations is not set)
+  unsigned long long allocs;
+  /// Constructor for phase \a n
+  PhaseStats(const char* n);
+};
+
+/**
+ * \brief Measures the scope where it is declared as a run of phase \a name.
+ *
+ * On destruction the measure is accumulated in the phase with the same name in
+ * \a phases or appended to it if there is no such phase. When tracing is
+ * compiled in, every run is also recorded as a trace event.
+ */
+class PhaseTimer {
+private:
+  typedef std::chrono::steady_clock clock;
+  /// Phases where the measure is accumulated
+  std::vector<PhaseStats>& phases;
+  /// Name of the phase
+  const char* name;
+  /// Start time
+  clock::time_point start;
+  /// Allocations at the start
+  unsigned long long allocs;
+public:
+  /// Starts measuring phase \a n
+  PhaseTimer(std::vector<PhaseStats>& phs, const char* n);
+  /// Stops the measure
+  ~PhaseTimer(void);
+};
+
+/// Output \a phases on \a os as a json array
+void writeJson(std::ostream& os, const std::vector<PhaseStats>& phases);
+
+/**
+ * \brief Cooperative cancellation of the translation and the reduction.
+ *
+ * The work checks the token periodically and stops when \a cancel was called
+ * or the deadline passed. The token can be cancelled from any thread. It is
+ * not modified by the work that checks it and can be reused after \a reset.
+ */
+class CancelToken {
+private:
+  typedef std::chrono::steady_clock clock;
+  /// Whether \a cancel was called
+  std::atomic<bool> cancelled_;
+  /// Deadline in ticks of the clock, the maximum value when there is none
+  std::atomic<clock::rep> deadline_;
+public:
+  /// Constructor of a token without deadline
+  CancelToken(void);
+  /// Requests the work to stop
+  void cancel(void);
+  /// Sets the deadline \a secs seconds from now
+  void deadline(double secs);
+  /// Removes the cancellation request and the deadline
+  void reset(void);
+  /// Tests whether \a cancel was called
+  bool cancelled(void) const;
+  /// Tests whether the work has to stop: cancelled or past the deadline
+  bool expired(void) const;
 };
 
 /**
@@ -218,16 +329,58 @@ public:
   unsigned int ed;
   /// Zero provided disjunctions
   unsigned int zp;
+  /// Packages left out of the cone of influence (only when pruning)
+  unsigned int pruned;
   /// Fail detected
   bool fail;
-  /// Constructor
-  TranslatorStats(void);
+  /// Phases of the construction of the kcudf data in execution order
+  std::vector<PhaseStats> phases;
+  /// Packages (concrete and disjunctions)
+  unsigned int pkgs;
+  /// Version constraints (size of constv)
+  unsigned int constv;
+  /// Package names with an equality constraint (size of specv)
+  unsigned int specv;
+  /// Versions stored for all the names in specv
+  unsigned int specv_versions;
+  /**
+   * \brief Histogram of forward chain lengths: \a fwd[i] disjunctions
+   * reach the package representing them after i forwards.
+   */
+  std::vector<unsigned int> fwd;
+  /**
+   * \brief Histogram of disjunction widths: \a width[0] disjunctions have
+   * no providers and \a width[i] have between 2^(i-1) and 2^i - 1 providers.
+   */
+  std::vector<unsigned int> width;
+  /// Memory report, only filled when it is enabled on construction
+  MemoryReport memory;
+  /// Constructor, \a memory enables the memory report
+  TranslatorStats(bool memory = false);
 };
 
+/// Output \a st on \a os as a json object
+void writeJson(std::ostream& os, const TranslatorStats& st);
+
 class DTNode;
 class KCudfWriter;
 class KCudfInfoWriter;
 
+/**
+ * \brief Request translated instead of the one of a cudf document.
+ *
+ * It replaces the request stanza of the document and overrides the installed
+ * state of some of its packages, so that one parsed universe can be
+ * translated for several requests without modifying it.
+ */
+class CudfRequest {
+public:
+  /// Document with the request stanza, its packages are ignored
+  CudfDoc request;
+  /// Installed state of the packages that differ from the document
+  std::map<std::pair<std::string,int>,bool> installed;
+};
+
 class KCudfData {
   friend std::ostream& operator<< (std::ostream& o,const KCudfData& kcudf);
 private:
@@ -312,9 +465,12 @@ private:
    */
   Disjunction* getDisjunction(const std::string& name);
   /**
-   * \brief Creates pairwise conflict between the packages in \a s.
+   * \brief Registers an at-most-one group among the packages in \a s.
+   *
+   * This is equivalent to a pairwise conflict between the packages of \a s
+   * but it is stored (and written) in space linear in the size of \a s.
    */
-  void pairwiseConflicting(const std::set<unsigned int>& s);
+  void atMostOne(const std::set<unsigned int>& s);
   /**
    * \brief Fix install attributes for virtual packages
    */
@@ -344,9 +500,46 @@ private:
   std::vector<int> crtPackages_;
   /// List of _consistent_ installed concrete packages
   mutable std::vector<int> conPackages_;
+  /// At-most-one groups
+  std::vector<std::vector<unsigned int> > groups_;
+  /// Whether the packages were restricted to the cone of influence
+  bool pruned_;
+  /// Canonical identifiers of the packages in the cone of influence
+  std::set<unsigned int> cone_;
+  /// Token checked during the construction (NULL if there is none)
+  const CancelToken* cancel_;
+  /// Request replacing the one of the document (NULL if there is none)
+  const CudfRequest* request_;
+  /// Returns the document whose request is translated
+  const CudfDoc& request(const CudfDoc& doc) const;
+  /// Tests whether package \a pi is installed, with the overrides of the request
+  bool installed(const CudfPackage& pi) const;
+  /**
+   * \brief Throws \a KCudfCancelled if the construction has to stop.
+   *
+   * It is called once per package by the phases of the construction.
+   */
+  void checkpoint(void) const;
+  /// Builds the data from the cudf document \a doc
+  void build(const CudfDoc& doc, TranslatorStats& stats);
+  /// Deletes all the packages
+  void release(void);
+  /// Copies are not allowed, the data owns the packages
+  KCudfData(const KCudfData&) = delete;
+  KCudfData& operator=(const KCudfData&) = delete;
 public:
-  /// Constructor from a cudf document
-  KCudfData(const CudfDoc& doc, TranslatorStats& stats);
+  /**
+   * \brief Constructor from a cudf document.
+   *
+   * If \a ct is given and expires during the construction \a KCudfCancelled
+   * is thrown, after deleting everything built so far. If \a rq is given it
+   * is translated instead of the request of \a doc. A package with keep
+   * version that is not installed throws \a KCudfFailure.
+   */
+  KCudfData(const CudfDoc& doc, TranslatorStats& stats,
+            const CancelToken* ct = NULL, const CudfRequest* rq = NULL);
+  /// Destructor
+  ~KCudfData(void);
   /// Constructor from a kcudf file
   KCudfData(const char* fname);
   /// Return all the information about packages
@@ -355,6 +548,35 @@ public:
   const std::set<int>& bigPackages(void) const;
   /// Return the list of installed concrete packages
   const std::vector<int>& crtPackages(void) const;
+  /// Return the at-most-one groups
+  const std::vector<std::vector<unsigned int> >& groups(void) const;
+  /**
+   * \brief Restricts the problem to the cone of influence of the installed
+   * packages.
+   *
+   * The roots are the packages marked install: the installed ones and the
+   * ones required by the request. The cone is closed under dependencies,
+   * provides (a provider depends on what it provides) and providers, except
+   * through packages kept uninstalled, which constrain nothing. Any
+   * solution of the problem restricted to the cone is a solution of the
+   * whole problem with every other package left uninstalled, and no package
+   * outside the cone is installed now. Conflicts and at-most-one groups only
+   * forbid installations, so they do not extend the cone.
+   *
+   * If \a paranoid is true the packages not marked keep of the families with
+   * an installed version are roots too, as \a
+   * KCudfTranslator::extraParanoid puts them in the search.
+   *
+   * The number of packages left out is recorded in \a stats.
+   */
+  void prune(TranslatorStats& stats, bool paranoid = false);
+  /// Tests whether package \a p is part of the problem after pruning
+  bool relevant(unsigned int p) const;
+  /**
+   * \brief Adds the memory used by the data to report \a r, including the
+   * disjunction tree \a dt if given.
+   */
+  void memory(MemoryReport& r, const DTNode* dt = NULL) const;
 };
 
 /// Output the information stored in \a kcudf
@@ -407,6 +629,8 @@ public:
   DTNode* getChild(unsigned int u);
   /// Adds a child \a c to the tree under the key \a u
   void addChild(unsigned int u, DTNode* c);
+  /// Adds the memory used by the tree to report \a r
+  void memory(MemoryReport& r) const;
 };
 
 /**
@@ -438,6 +662,18 @@ class KCudfInvalidProvide : public KCudfFailure {
 public:
   KCudfInvalidProvide(const char* s) : KCudfFailure(s) { }
 };
+
+/**
+ * \brief Exception when the translation is cancelled or its deadline passes
+ * (see \a CancelToken).
+ *
+ * Nothing is left behind: the translator can be destroyed and another one
+ * created with the same document.
+ */
+class KCudfCancelled : public KCudfFailure {
+public:
+  KCudfCancelled(const char* s) : KCudfFailure(s) { }
+};
 /**
  * \brief Writer for kcudf parsed documents.
  *
@@ -470,6 +706,20 @@ public:
    * \brief Process provides relation: \a p provides \a q.
    */
   virtual void provides(unsigned int p, unsigned int q, const char* desc);
+  /**
+   * \brief Process at-most-one relation: at most one of the packages in \a g
+   * can be installed.
+   *
+   * By default the group is passed to \a conflict as pairwise conflicts, so
+   * writers that only handle conflicts keep working.
+   */
+  virtual void atMostOne(const std::vector<unsigned int>& g, const char* desc);
+  /**
+   * \brief Process package \a p, already passed to \a package as installed,
+   * that has no safe provider yet: the solver must install one of its
+   * providers. It is ignored by default.
+   */
+  virtual void unprovided(unsigned int p);
 };
 
 class KCudfInfoWriter {
@@ -481,6 +731,15 @@ public:
    * kcudf input.
    */
   virtual void package(unsigned int id, unsigned int version, const char* name);
+  /**
+   * \brief This method is called for every artificial package (disjunction)
+   * with description \a desc.
+   *
+   * By default the package is passed to \a package with version 0, which is
+   * how text info files store artificial packages: cudf versions are
+   * positive, so it never clashes with a concrete package.
+   */
+  virtual void artificial(unsigned int id, const char* desc);
 };
 
 /**
@@ -494,21 +753,80 @@ private:
   TranslatorStats st;
   /// Interpretation of the Cudf
   KCudfData data;
+  /// Token checked by \a translate (NULL if there is none)
+  const CancelToken* cancel;
   /// Default constructor
   KCudfTranslator();
+  /// Relation between two packages
+  typedef std::pair<unsigned int, unsigned int> relation_t;
+  /// Relations of one section of the output, in emission order
+  struct Section {
+    /// The relations of the section
+    std::vector<relation_t> rels;
+    /// Description of every relation, only filled when debugging
+    std::vector<std::string> descs;
+    /// Appends relation \a a, \a b with description \a d (kept if \a debug)
+    void add(unsigned int a, unsigned int b, std::string&& d, bool debug) {
+      rels.emplace_back(a, b);
+      if (debug)
+        descs.push_back(std::move(d));
+    }
+    /// Returns the description of the \a i-th relation ("" when not debugging)
+    const char* desc(size_t i) const {
+      return descs.empty() ? "" : descs[i].c_str();
+    }
+  };
+  /**
+   * \brief Tests whether \a p is stored under its own identifier.
+   *
+   * Forwarded disjunctions are stored under their original identifier but
+   * report the one of the package they are forwarded to, which is canonical
+   * itself. Visiting only canonical entries handles every package once.
+   */
+  static bool canonical(const std::pair<const unsigned int, Package*>& p) {
+    return p.first == p.second->getId();
+  }
+  /// Tests whether \a p is canonical and part of the translated problem
+  bool emitted(const std::pair<const unsigned int, Package*>& p) const {
+    return canonical(p) && data.relevant(p.first);
+  }
   /// Helper method to write information about packages
-  void writePackages(KCudfWriter& wrt, KCudfInfoWriter& inf, bool debug);
+  template <class Writer, class InfoWriter>
+  void writePackages(Writer& wrt, InfoWriter& inf, bool debug) const;
   /// Helper method to write information about concrete packages
-  void writeConcreteSelfProvided(KCudfWriter& wrt, bool debug);
-  /// Helper method to write information about dependencies
-  void writeDependencies(KCudfWriter& wrt, bool debug);
-  /// Helper method to write information about conflicts
-  void writeConflicts(KCudfWriter& wrt, bool debug);
-  /// Helper method to write information about provides
-  void writeProvides(KCudfWriter& wrt, bool debug);
+  template <class Writer>
+  void writeConcreteSelfProvided(Writer& wrt, bool debug) const;
+  /// Helper method to collect the dependencies in \a s
+  void collectDependencies(Section& s, bool debug) const;
+  /// Helper method to collect the conflicts in \a s
+  void collectConflicts(Section& s, bool debug) const;
+  /// Helper method to collect the provides in \a s
+  void collectProvides(Section& s, bool debug) const;
+  /// Helper method to write the at-most-one groups
+  template <class Writer>
+  void writeGroups(Writer& wrt, bool debug) const;
 public:
-  /// Constructor
-  KCudfTranslator(const CudfDoc& d);
+  /**
+   * \brief Constructor.
+   *
+   * If \a memory is true the memory used by the translation is reported in
+   * the statistics.
+   */
+  KCudfTranslator(const CudfDoc& d, bool memory = false);
+  /**
+   * \brief Constructor.
+   *
+   * If \a prune is true only the cone of influence of the installed packages
+   * is translated (see KCudfData::prune). If \a ct is given the construction
+   * and \a translate throw \a KCudfCancelled when it expires; \a translate
+   * only checks it before writing anything. If \a rq is given it is
+   * translated instead of the request of \a d (see \a CudfRequest). The
+   * cone keeps the versions needed by \a extraParanoid when \a paranoid is
+   * true.
+   */
+  KCudfTranslator(const CudfDoc& d, bool memory, bool prune,
+                  const CancelToken* ct = NULL, const CudfRequest* rq = NULL,
+                  bool paranoid = false);
   /**
    * \brief Translate the document.
    *
@@ -516,8 +834,22 @@ public:
    * - Packages
    * - Dependencies
    * - Conflicts
+   * - At-most-one groups
    * - Provides
+   *
+   * Every conflict is written once, with the smaller identifier first.
+   *
+   * The relations of the last three sections are collected concurrently
+   * (one thread per section) while packages are written, and then passed
+   * to \a w in the order above. The writers are only called from the
+   * calling thread.
+   *
+   * The writers are statically dispatched: calls to a writer whose class (or
+   * methods) are final are resolved at compile time.
    */
+  template <class Writer, class InfoWriter>
+  void translate(Writer& w, InfoWriter& i, bool dbg = false);
+  /// Translate the document through the virtual writer interface
   void translate(KCudfWriter& w, KCudfInfoWriter& i, bool dbg = false);
   /// Return translation statistics
   const TranslatorStats& stats(void) const;
@@ -538,6 +870,133 @@ public:
   const std::vector<int>& crtInstalled(void) const;
 };
 
+template <class Writer, class InfoWriter>
+void KCudfTranslator::writePackages(Writer& wrt, InfoWriter& inf, bool debug) const {
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
+  // concrete packages
+  for (auto p = packages.begin(); p != packages.end(); ++p) {
+    if (emitted(*p) && p->second->isConcrete()) {
+      SelfPackage *pk = static_cast<SelfPackage*> (p->second);
+      std::ostringstream desc;
+      desc << pk->getVersion() << pk->name();
+      wrt.package(pk->getId(), pk->markedKeep(), pk->markedInstall(), desc.str().c_str());
+      inf.package(pk->getId(), pk->getVersion(), pk->name().c_str());
+    }
+  }
+  // artificial packages
+  for (auto p = packages.begin(); p != packages.end(); ++p) {
+    if (emitted(*p) && !p->second->isConcrete()) {
+      Package *rp = p->second;
+      const char *info = debug ? rp->getInfo() : "";
+      wrt.package(rp->getId(), rp->markedKeep(), rp->markedInstall(), info);
+      inf.artificial(rp->getId(), info);
+    }
+  }
+}
+
+template <class Writer>
+void KCudfTranslator::writeConcreteSelfProvided(Writer& wrt, bool debug) const {
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
+  // single disjunctions corresponding to concrete packages
+  for (auto p = packages.begin(); p != packages.end(); ++p) {
+    if (emitted(*p) && p->second->isConcrete()) {
+      SelfPackage *pk = static_cast<SelfPackage*> (p->second);
+      std::ostringstream desc;
+      if (debug) {
+        desc << pk->getVersion() << pk->name() << "-self";
+      }
+      wrt.provides(pk->getId(), pk->getId(), desc.str().c_str());
+    }
+  }
+}
+
+template <class Writer>
+void KCudfTranslator::writeGroups(Writer& wrt, bool debug) const {
+  const std::map<unsigned int,Package*>& packages = data.getPackages();
+  for (const std::vector<unsigned int>& g : data.groups()) {
+    std::vector<unsigned int> ids;
+    std::string desc;
+    for (unsigned int p : g) {
+      Package *rp = packages.at(p);
+      // members outside the cone stay uninstalled
+      if (!data.relevant(rp->getId()))
+        continue;
+      ids.push_back(rp->getId());
+      if (debug)
+        desc.append(desc.empty() ? "" : " | ").append(rp->getInfo());
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    if (ids.size() > 1)
+      wrt.atMostOne(ids, desc.c_str());
+  }
+}
+
+template <class Writer, class InfoWriter>
+void KCudfTranslator::translate(Writer& wrt, InfoWriter& inf, bool dbg) {
+  KCUDF_TRACE_SCOPE("translate");
+  if (cancel != NULL && cancel->expired())
+    throw KCudfCancelled(cancel->cancelled() ? "translation cancelled" :
+                         "translation deadline expired");
+  Section deps, confs, pvds;
+  // the relations are collected while the packages are written
+  std::thread tc(&KCudfTranslator::collectConflicts, this, std::ref(confs), dbg);
+  std::thread tp(&KCudfTranslator::collectProvides, this, std::ref(pvds), dbg);
+  {
+    // the collectors are joined even if writing the packages throws
+    struct Joiner {
+      std::thread& c;
+      std::thread& p;
+      ~Joiner(void) {
+        if (c.joinable()) c.join();
+        if (p.joinable()) p.join();
+      }
+    } joiner{tc, tp};
+    {
+      KCUDF_TRACE_SCOPE("write packages");
+      writePackages(wrt, inf, dbg);
+    }
+    collectDependencies(deps, dbg);
+    KCUDF_TRACE_SCOPE("join collectors");
+    tc.join();
+    tp.join();
+  }
+
+  MemoryReport& mr = st.memory;
+  if (mr.enabled()) {
+    mr.begin();
+    data.memory(mr);
+    for (const Section* s : {&deps, &confs, &pvds}) {
+      size_t b = heapBytes(s->rels) + heapBytes(s->descs);
+      for (const std::string& d : s->descs)
+        b += heapBytes(d);
+      mr.add("translate sections", s->rels.size(), b);
+    }
+    mr.end();
+  }
+
+  {
+    KCUDF_TRACE_SCOPE("write dependencies");
+    for (size_t i = 0; i < deps.rels.size(); i++)
+      wrt.dependency(deps.rels[i].first, deps.rels[i].second, deps.desc(i));
+  }
+  {
+    KCUDF_TRACE_SCOPE("write conflicts");
+    for (size_t i = 0; i < confs.rels.size(); i++)
+      wrt.conflict(confs.rels[i].first, confs.rels[i].second, confs.desc(i));
+  }
+  {
+    KCUDF_TRACE_SCOPE("write groups");
+    writeGroups(wrt, dbg);
+  }
+  KCUDF_TRACE_SCOPE("write provides");
+  writeConcreteSelfProvided(wrt, dbg);
+  for (size_t i = 0; i < pvds.rels.size(); i++) {
+    wrt.provides(pvds.rels[i].first, pvds.rels[i].second, pvds.desc(i));
+    wrt.dependency(pvds.rels[i].first, pvds.rels[i].second, pvds.desc(i));
+  }
+}
+
 /**
  * \brief Failed stream exception
  */
@@ -565,7 +1024,17 @@ public:
  *
  * \warning This procedure does not care abut any repeated relation so it is up
  * to the writer to implement this functionality if required.
+ *
+ * Besides packages (P), dependencies (D), conflicts (C) and provides (R) a line
+ * "A id1 id2 ... idn" states that at most one of the listed packages can be
+ * installed; it is passed to \a KCudfWriter::atMostOne.
+ *
+ * The writer is statically dispatched: calls to a writer whose class (or
+ * methods) are final are resolved at compile time.
  */
+template <class Writer>
+void read(std::istream& input, Writer& wrt);
+/// Parse the kcudf in \a input through the virtual writer interface
 void read(std::istream& input, KCudfWriter& wrt);
 /**
  * \brief Exception for malformed KCUDF file
@@ -577,8 +1046,96 @@ class KCudfReaderInvalidStatement : public KCudfFailure {
 public:
   KCudfReaderInvalidStatement(const char* s) : KCudfFailure(s) { }
 };
+
+/**
+ * \brief Reads a package identifier at \a s (after blanks) into \a id.
+ *
+ * Returns false if there is no identifier at \a s. On success \a s is left
+ * right after the identifier.
+ */
+inline bool readId(const char*& s, unsigned int& id) {
+  while (*s == ' ' || *s == '\t') s++;
+  if (!std::isdigit(static_cast<unsigned char>(*s))) return false;
+  char *e;
+  id = std::strtoul(s, &e, 10);
+  s = e;
+  return true;
+}
+
+/// Reads the next non blank character at \a s
+inline char readFlag(const char*& s) {
+  while (*s == ' ' || *s == '\t') s++;
+  return *s == '\0' ? *s : *s++;
+}
+
+template <class Writer>
+void read(std::istream& input, Writer& wrt) {
+  KCUDF_TRACE_SCOPE("read");
+  if (input.fail())
+    throw FailedStream("unable to open stream for reading");
+
+  char inst, keep;
+  unsigned int id, id2;
+  unsigned int ln = 0; // line number
+  std::vector<unsigned int> g;
+
+  std::string line;
+  while(input.good()) {
+    std::getline(input, line);
+    ln++;
+    if (line.empty()) continue;
+    const char *s = line.c_str() + 1;
+    bool ok = true;
+    switch (line[0]) {
+    case 'P':
+      ok = readId(s, id);
+      keep = readFlag(s); inst = readFlag(s);
+      if (ok) {
+        wrt.package(id, keep == 'K', inst == 'I', "");
+        // Make explicit a self dependency for all the packages
+        wrt.dependency(id, id, "self-dep");
+      }
+      break;
+    case 'D':
+      if ((ok = readId(s, id) && readId(s, id2)))
+        wrt.dependency(id, id2, "");
+      break;
+    case 'C':
+      if ((ok = readId(s, id) && readId(s, id2)))
+        wrt.conflict(id, id2, "");
+      break;
+    case 'R':
+      if ((ok = readId(s, id) && readId(s, id2)))
+        wrt.provides(id, id2, "");
+      break;
+    case 'A':
+      // identifiers up to the end of the line or the description
+      g.clear();
+      while (readId(s, id))
+        g.push_back(id);
+      wrt.atMostOne(g, "");
+      break;
+    case '#':
+      // just to allow comments starting with #
+      break;
+    default:
+      ok = false;
+      break;
+    }
+    if (!ok) {
+      std::ostringstream ss;
+      ss << "Unknown statement found while reading line: ..." << line
+         << std::endl
+         << " at line: " << ln;
+      throw KCudfReaderInvalidStatement(ss.str().c_str());
+    }
+  }
+}
 /**
  * \brief Reads the info file \a info and puts the information in \a m.
+ *
+ * The file can be compressed (see \a InputFile) or be an info index (see \a
+ * KCudfInfoIndex). Artificial packages (version 0) are not stored in \a m.
  */
 void readInfo(const char* info, std::map<std::string,std::map<unsigned int, unsigned int> >& m);
 void readInfo(const char* info, KCudfInfoWriter& wrt);
@@ -597,31 +1154,188 @@ translate(const CudfDoc& doc, const char* kcudf, const char* info,
 /**
  * \brief Updates \a doc with the information contained in \a kcudf0 and \a kcudf1
  * the information used for the translation is in \a info.
+ *
+ * Only the package records of the kcudf files are read (see \a readPackages).
+ * If \a renumber is not NULL, \a kcudf1 is the solution of a search part
+ * written with that renumbering table (see \a KCudfRenumbering) and its
+ * identifiers are translated back before the update. If \a merge is not NULL,
+ * it names the classes of the packages merged in the search part (see \a
+ * KCudfMerging) and their members follow their representative in \a kcudf1.
+ */
+void update(CudfDoc& doc, const char* info, const char* kcudf0, const char* kcudf1,
+            const char* renumber = NULL, const char* merge = NULL);
+/**
+ * \brief Updates \a doc as the previous function does but reading the kcudf
+ * content from streams \a kcudf0 and \a kcudf1.
  */
-void update(CudfDoc& doc, const char* info, const char* kcudf0, const char* kcudf1);
+void update(CudfDoc& doc, const char* info, std::istream& kcudf0, std::istream& kcudf1,
+            const char* renumber = NULL, const char* merge = NULL);
 
 /**
  * \brief Writer for updating a cudf document
+ *
+ * Only package records are relevant for the update, relations are ignored.
  */
-class CudfUpdater : public KCudfWriter {
+class CudfUpdater final : public KCudfWriter {
 private:
-  /// Mapping kcudf identifiers to package pointers
-  std::map<unsigned int, CudfPackage*> status;
+  /// Mapping kcudf identifiers to package pointers (NULL if not concrete)
+  std::vector<CudfPackage*> status;
+  /// Packages of the document by name (only while the info is resolved)
+  std::map<std::string, std::vector<CudfPackage*> > byName;
   CudfUpdater(void);
   /// Number of packages that were updated
   unsigned int changed;
+  /// Associates identifier \a id with package \a pk
+  void associate(unsigned int id, CudfPackage* pk);
+  /// Returns the package with \a name and \a version (NULL if there is none)
+  CudfPackage* find(const char* name, unsigned int version) const;
 public:
-  CudfUpdater(CudfDoc& doc, std::map<std::string,std::map<unsigned int, unsigned int> >& m);
+  CudfUpdater(CudfDoc& doc, const std::map<std::string,std::map<unsigned int, unsigned int> >& m);
+  /**
+   * \brief Constructor for updating \a doc using the info file \a info (text
+   * or index).
+   *
+   * Every identifier of the info is resolved to its package once, so that
+   * reading a package record is a single vector access.
+   */
+  CudfUpdater(CudfDoc& doc, const char* info);
+  /// Destructor
+  ~CudfUpdater(void);
   void package(unsigned int id, bool keep, bool install, const char* desc);
-  void dependency(unsigned int id, unsigned int id2, const char* desc);
-  void conflict(unsigned int id, unsigned int id2, const char* desc);
-  void provides(unsigned int id, unsigned int id2, const char* desc);
+  void dependency(unsigned int id, unsigned int id2, const char* desc) final;
+  void conflict(unsigned int id, unsigned int id2, const char* desc) final;
+  void provides(unsigned int id, unsigned int id2, const char* desc) final;
+  void atMostOne(const std::vector<unsigned int>& g, const char* desc) final;
   unsigned int stats(void) const;
 };
+
+/**
+ * \brief First line of a compact solved file (see \a KCudfSolvedWriter)
+ */
+const char* const KCUDF_SOLVED_HEADER = "#KCUDF-SOLVED 1";
+
+/**
+ * \brief Decodes the body (everything after the header) of a compact solved
+ * file in \a input and passes every package to \a wrt.
+ *
+ * Packages are reported as keep. The packages without safe provider are then
+ * passed to \a unprovided.
+ */
+template <class Writer>
+void readSolvedBody(std::istream& input, Writer& wrt) {
+  unsigned int id = 0, n, p;
+  std::string line;
+  while (std::getline(input, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    const char *s = line.c_str() + 1;
+    bool ok = true;
+    switch (line[0]) {
+    case 'R':
+      // runs: I<n> installed, U<n> uninstalled, S<n> not in the file
+      for (char r = readFlag(s); ok && r != '\0'; r = readFlag(s)) {
+        if (!(ok = readId(s, n))) break;
+        switch (r) {
+        case 'I':
+        case 'U':
+          for (unsigned int e = id + n; id < e; id++)
+            wrt.package(id, true, r == 'I', "");
+          break;
+        case 'S':
+          id += n;
+          break;
+        default:
+          ok = false;
+        }
+      }
+      break;
+    case 'Z':
+      while (readId(s, p))
+        wrt.unprovided(p);
+      break;
+    default:
+      ok = false;
+    }
+    if (!ok) {
+      std::ostringstream ss;
+      ss << "Invalid statement in compact solved file: " << line;
+      throw KCudfReaderInvalidStatement(ss.str().c_str());
+    }
+  }
+}
+
+/**
+ * \brief Reads the compact solved file in \a input and passes every package to
+ * \a wrt (see \a readSolvedBody).
+ */
+template <class Writer>
+void readSolved(std::istream& input, Writer& wrt) {
+  KCUDF_TRACE_SCOPE("readSolved");
+  if (input.fail())
+    throw FailedStream("unable to open stream for reading");
+  std::string line;
+  std::getline(input, line);
+  if (line != KCUDF_SOLVED_HEADER)
+    throw KCudfReaderInvalidStatement("missing compact solved header");
+  readSolvedBody(input, wrt);
+}
+
+/**
+ * \brief Reads only the package records (P lines) of the kcudf in \a input
+ * and passes them to \a wrt.
+ *
+ * Other lines are skipped without being parsed, so the cost is linear in the
+ * number of packages and not in the number of relations. Unlike \a read, no
+ * self dependency is reported.
+ *
+ * Compact solved files (see \a readSolved) are recognized by their header and
+ * decoded as well.
+ */
+template <class Writer>
+void readPackages(std::istream& input, Writer& wrt) {
+  KCUDF_TRACE_SCOPE("readPackages");
+  if (input.fail())
+    throw FailedStream("unable to open stream for reading");
+
+  unsigned int id;
+  unsigned int ln = 0; // line number
+  std::string line;
+  while (input.good()) {
+    int c = input.peek();
+    if (c == '#' && ln == 0) {
+      std::getline(input, line);
+      ln++;
+      if (line == KCUDF_SOLVED_HEADER) {
+        readSolvedBody(input, wrt);
+        return;
+      }
+      continue;
+    }
+    ln++;
+    if (c != 'P') {
+      input.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+      continue;
+    }
+    std::getline(input, line);
+    const char *s = line.c_str() + 1;
+    if (!readId(s, id)) {
+      std::ostringstream ss;
+      ss << "Invalid package statement: " << line;
+      throw KCudfReaderInvalidStatement(ss.str().c_str());
+    }
+    char keep = readFlag(s);
+    char inst = readFlag(s);
+    wrt.package(id, keep == 'K', inst == 'I', "");
+  }
+}
 /**
  * \brief Convenience function to update \a doc with the information contained
  * in files \a info, \a easy and \a solved.
  *
+ * If the search part was written with a renumbering table, \a renumber names
+ * it and the identifiers of \a solved are translated back with it. If its
+ * equivalent packages were merged, \a merge names the file with the classes
+ * and the members get the value of their representative in \a solved.
+ *
  * \warning Only solved can be a NULL representing the fact that everything was
  * probably solved by the translator or the reducer.
  *
@@ -629,9 +1343,11 @@ public:
  * \callgraph
  */
 void format(CudfDoc& doc, const char* info, const char* easy,
-            const char* solved = NULL);
+            const char* solved = NULL, const char* renumber = NULL,
+            const char* merge = NULL);
 void format(CudfDoc& doc, const char* info, const char* easy,
-            std::istream& solved);
+            std::istream& solved, const char* renumber = NULL,
+            const char* merge = NULL);
 
 class KCudfInfoMapWriter : public KCudfInfoWriter {
 public:
@@ -0,0 +1,112 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <iomanip>
+#include <algorithm>
+#include <kcudf/memory.hh>
+
+MemoryReport::Entry::Entry(const char* n)
+  : name(n), count(0), bytes(0), max_count(0), max_bytes(0) {}
+
+size_t (*MemoryReport::heapInUse)(void) = NULL;
+size_t (*MemoryReport::heapPeak)(void) = NULL;
+
+MemoryReport::MemoryReport(bool enabled)
+  : on(enabled), heap(0) {}
+
+bool MemoryReport::enabled(void) const {
+  return on;
+}
+
+MemoryReport::Entry& MemoryReport::entry(const char* name) {
+  for (Entry& e : entries_)
+    if (e.name == name)
+      return e;
+  entries_.push_back(Entry(name));
+  return entries_.back();
+}
+
+void MemoryReport::begin(void) {
+  for (Entry& e : entries_) {
+    e.count = 0;
+    e.bytes = 0;
+  }
+}
+
+void MemoryReport::add(const char* name, size_t count, size_t bytes) {
+  Entry& e = entry(name);
+  e.count += count;
+  e.bytes += bytes;
+}
+
+void MemoryReport::end(void) {
+  for (Entry& e : entries_) {
+    e.max_count = std::max(e.max_count, e.count);
+    e.max_bytes = std::max(e.max_bytes, e.bytes);
+  }
+  if (heapInUse)
+    heap = heapInUse();
+}
+
+const std::vector<MemoryReport::Entry>& MemoryReport::entries(void) const {
+  return entries_;
+}
+
+size_t MemoryReport::counted(void) const {
+  return heap;
+}
+
+std::ostream& operator<< (std::ostream& os, const MemoryReport& r) {
+  size_t live = 0, max = 0;
+  os << "Memory report (estimated heap bytes, max over snapshots):" << std::endl
+     << std::left << std::setw(36) << "\tstructure" << std::right
+     << std::setw(12) << "elements" << std::setw(14) << "estimate"
+     << std::setw(12) << "max elems" << std::setw(14) << "max" << std::endl;
+  for (const MemoryReport::Entry& e : r.entries()) {
+    os << "\t" << std::left << std::setw(35) << e.name << std::right
+       << std::setw(12) << e.count << std::setw(14) << e.bytes
+       << std::setw(12) << e.max_count << std::setw(14) << e.max_bytes << std::endl;
+    live += e.bytes;
+    max += e.max_bytes;
+  }
+  os << "\t" << std::left << std::setw(35) << "total" << std::right
+     << std::setw(26) << live << std::setw(26) << max << std::endl;
+  if (MemoryReport::heapInUse)
+    os << "\t" << std::left << std::setw(35) << "counted heap in use" << std::right
+       << std::setw(26) << r.counted() << std::endl;
+  if (MemoryReport::heapPeak)
+    os << "\t" << std::left << std::setw(35) << "counted heap peak" << std::right
+       << std::setw(26) << MemoryReport::heapPeak() << std::endl;
+  return os;
+}
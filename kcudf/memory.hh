@@ -0,0 +1,167 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__MEMORY__HH__
+#define __KCUDF__MEMORY__HH__
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <set>
+#include <map>
+
+/**
+ * \file Memory accounting of the main data structures.
+ *
+ * The accounting is done by walking the data structures on demand and
+ * estimating the heap bytes each one uses, so it costs nothing unless a report
+ * is requested. The estimates assume node based containers with one heap
+ * block per element (as in libstdc++) and an allocator rounding every block
+ * to 16 bytes plus a word of overhead.
+ *
+ * The estimates only cover the structures that are walked. Applications that
+ * count the allocations themselves can install \a MemoryReport::heapInUse and
+ * \a MemoryReport::heapPeak so that reports also show the heap really used.
+ */
+
+/**
+ * \brief Report of the memory used by data structures.
+ *
+ * A report is made of snapshots: \a begin starts one, every data structure
+ * is added to it with \a add and \a end closes it. The live values of an
+ * entry are the ones of the last snapshot and its max values are the
+ * maximum over all the snapshots. Both are estimates, and the max values are
+ * not a peak: structures can grow and shrink between snapshots.
+ */
+class MemoryReport {
+public:
+  /// Memory used by one data structure
+  class Entry {
+  public:
+    /// Name of the data structure
+    std::string name;
+    /// Elements in the last snapshot
+    size_t count;
+    /// Bytes in the last snapshot
+    size_t bytes;
+    /// Maximum number of elements over all the snapshots
+    size_t max_count;
+    /// Maximum number of bytes over all the snapshots
+    size_t max_bytes;
+    /// Constructor for data structure \a n
+    Entry(const char* n);
+  };
+private:
+  /// Whether the report was requested
+  bool on;
+  /// Entries in order of first appearance
+  std::vector<Entry> entries_;
+  /// Heap bytes in use counted at the end of the last snapshot
+  size_t heap;
+  /// Returns the entry for data structure \a name, creating it if needed
+  Entry& entry(const char* name);
+public:
+  /**
+   * \brief Function returning the heap bytes in use by the program.
+   *
+   * The library does not count allocations by itself (see
+   * PhaseStats::allocations). When set, every snapshot records the result.
+   */
+  static size_t (*heapInUse)(void);
+  /// Function returning the maximum heap bytes used so far by the program
+  static size_t (*heapPeak)(void);
+  /// Constructor for an enabled or disabled report
+  MemoryReport(bool enabled = false);
+  /// Tests whether the report was requested
+  bool enabled(void) const;
+  /// Starts a new snapshot
+  void begin(void);
+  /// Adds \a count elements using \a bytes bytes to data structure \a name
+  void add(const char* name, size_t count, size_t bytes);
+  /// Ends the current snapshot
+  void end(void);
+  /// Return the entries of the report
+  const std::vector<Entry>& entries(void) const;
+  /// Returns the heap bytes in use counted at the end of the last snapshot
+  size_t counted(void) const;
+};
+
+/**
+ * \brief Output of memory report \a r to stream \a os.
+ *
+ * The max total is the sum of the max values of the entries. When the heap
+ * counters are installed the counted heap in use and its peak are also
+ * output.
+ */
+std::ostream& operator<< (std::ostream& os, const MemoryReport& r);
+
+/// \name Estimates of heap usage
+//@{
+/// Bytes of the heap block allocated for \a n bytes
+inline size_t heapBlock(size_t n) {
+  return (n + sizeof(void*) + 15) & ~static_cast<size_t>(15);
+}
+/// Overhead of a node of a balanced tree (color and three links)
+const size_t TREE_NODE = 4 * sizeof(void*);
+/// Overhead of a node of a doubly linked list
+const size_t LIST_NODE = 2 * sizeof(void*);
+
+/// Heap bytes of string \a s (short strings are stored inline)
+inline size_t heapBytes(const std::string& s) {
+  return s.capacity() > 15 ? heapBlock(s.capacity() + 1) : 0;
+}
+/// Heap bytes of the buffer of vector \a v (not of its elements)
+template <class T>
+inline size_t heapBytes(const std::vector<T>& v) {
+  return v.capacity() > 0 ? heapBlock(v.capacity() * sizeof(T)) : 0;
+}
+/// Heap bytes of the nodes of list \a l (not of its elements)
+template <class T>
+inline size_t heapBytes(const std::list<T>& l) {
+  return l.size() * heapBlock(LIST_NODE + sizeof(T));
+}
+/// Heap bytes of the nodes of set \a s (not of its elements)
+template <class T, class C>
+inline size_t heapBytes(const std::set<T,C>& s) {
+  return s.size() * heapBlock(TREE_NODE + sizeof(T));
+}
+/// Heap bytes of the nodes of map \a m (not of its keys nor values)
+template <class K, class V, class C>
+inline size_t heapBytes(const std::map<K,V,C>& m) {
+  return m.size() * heapBlock(TREE_NODE + sizeof(typename std::map<K,V,C>::value_type));
+}
+//@}
+
+#endif
@@ -0,0 +1,218 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <unordered_map>
+#include <kcudf/merge.hh>
+
+/*
+ * KCudfMerging
+ */
+void KCudfMerging::add(const Class& c) {
+  reps[c.rep] = cls.size();
+  cls.push_back(c);
+}
+
+unsigned int KCudfMerging::merged(void) const {
+  unsigned int n = 0;
+  for (const Class& c : cls)
+    n += c.members.size();
+  return n;
+}
+
+const KCudfMerging::Class* KCudfMerging::find(unsigned int p) const {
+  auto i = reps.find(p);
+  return i == reps.end() ? NULL : &cls[i->second];
+}
+
+void KCudfMerging::write(std::ostream& os) const {
+  for (const Class& c : cls) {
+    os << c.rep << (c.all ? " all" : " one");
+    for (unsigned int q : c.members)
+      os << " " << q;
+    os << '\n';
+  }
+}
+
+void KCudfMerging::read(std::istream& is) {
+  std::string line, mode;
+  while (std::getline(is, line)) {
+    std::istringstream ss(line);
+    Class c;
+    if (!(ss >> c.rep >> mode))
+      continue;
+    c.all = (mode == "all");
+    unsigned int q;
+    while (ss >> q)
+      c.members.push_back(q);
+    add(c);
+  }
+}
+
+/*
+ * KCudfMergeWriter
+ */
+KCudfMergeWriter::KCudfMergeWriter(KCudfWriter& w)
+  : KCudfBufferWriter(w) {}
+
+KCudfMergeWriter::~KCudfMergeWriter(void) {}
+
+namespace {
+  /// Hash of a package signature
+  struct SignatureHash {
+    size_t operator()(const std::vector<unsigned int>& s) const {
+      size_t h = s.size();
+      for (unsigned int x : s)
+        h ^= x + 0x9e3779b9 + (h << 6) + (h >> 2);
+      return h;
+    }
+  };
+  /// Marker for relations of a package with itself
+  const unsigned int SELF = ~0u;
+  /// Neighbourhoods of a package
+  enum NEIGHBOURHOOD {
+    NB_DEPS = 0,   ///> Dependencies
+    NB_DEPENDERS,  ///> Packages depending on it
+    NB_CONFS,      ///> Conflicts
+    NB_PVDS,       ///> Packages it provides
+    NB_PVDRS,      ///> Its providers
+    NB_COUNT       ///> Number of neighbourhoods
+  };
+  /**
+   * \brief Signatures of packages: the keep and install flags followed, for
+   * every neighbourhood in order, by its size and its sorted members.
+   */
+  namespace Signature {
+    /// Position of the keep flag
+    const unsigned int KEEP = 0;
+    /// Position of the install flag
+    const unsigned int INSTALL = 1;
+    /// Size of neighbourhood \a k in signature \a s
+    unsigned int size(const std::vector<unsigned int>& s, NEIGHBOURHOOD k) {
+      size_t i = INSTALL + 1;
+      for (unsigned int j = NB_DEPS; j < k; j++)
+        i += 1 + s[i];
+      return s[i];
+    }
+  }
+}
+
+void KCudfMergeWriter::flush(KCudfMerging& m) {
+  KCUDF_TRACE_SCOPE("merge");
+  const unsigned int NB = NB_COUNT;
+  const std::map<unsigned int, unsigned int> idx = index();
+  std::vector<std::vector<unsigned int> > nb(NB * pkgs.size());
+  std::vector<bool> grouped(pkgs.size(), false);
+  auto add = [&](unsigned int p, NEIGHBOURHOOD k, unsigned int q) {
+    auto i = idx.find(p);
+    if (i != idx.end())
+      nb[NB * i->second + k].push_back(p == q ? SELF : q);
+  };
+  for (auto& r : deps) {
+    if (r.first == r.second) continue;
+    add(r.first, NB_DEPS, r.second);
+    add(r.second, NB_DEPENDERS, r.first);
+  }
+  for (auto& r : confs) {
+    add(r.first, NB_CONFS, r.second);
+    add(r.second, NB_CONFS, r.first);
+  }
+  for (auto& r : pvds) {
+    add(r.first, NB_PVDS, r.second);
+    add(r.second, NB_PVDRS, r.first);
+  }
+  for (auto& g : groups)
+    for (unsigned int p : g) {
+      auto i = idx.find(p);
+      if (i != idx.end()) grouped[i->second] = true;
+    }
+
+  // classes of packages with the same signature
+  std::unordered_map<std::vector<unsigned int>, std::vector<unsigned int>,
+                     SignatureHash> sigs;
+  std::vector<unsigned int> rep(pkgs.size());
+  for (size_t i = 0; i < pkgs.size(); i++) {
+    rep[i] = i;
+    if (grouped[i]) continue;
+    // see Signature for the layout
+    std::vector<unsigned int> s;
+    s.push_back(std::get<1>(pkgs[i]));
+    s.push_back(std::get<2>(pkgs[i]));
+    for (unsigned int k = NB_DEPS; k < NB; k++) {
+      std::vector<unsigned int>& n = nb[NB * i + k];
+      std::sort(n.begin(), n.end());
+      n.erase(std::unique(n.begin(), n.end()), n.end());
+      s.push_back(n.size());
+      s.insert(s.end(), n.begin(), n.end());
+    }
+    std::vector<unsigned int>& c = sigs[s];
+    if (!c.empty())
+      rep[i] = c.front();
+    c.push_back(i);
+  }
+  nb.clear();
+  for (auto& c : sigs) {
+    if (c.second.size() < 2) continue;
+    unsigned int r = c.second.front();
+    KCudfMerging::Class mc;
+    mc.rep = std::get<0>(pkgs[r]);
+    // uninstalled members without dependers are not needed with the representative
+    mc.all = c.first[Signature::INSTALL]
+      || Signature::size(c.first, NB_DEPENDERS) > 0;
+    for (size_t j = 1; j < c.second.size(); j++)
+      mc.members.push_back(std::get<0>(pkgs[c.second[j]]));
+    m.add(mc);
+  }
+
+  // merged problem
+  auto id = [&](unsigned int p) -> unsigned int {
+    auto i = idx.find(p);
+    return i == idx.end() ? p : std::get<0>(pkgs[rep[i->second]]);
+  };
+  for (size_t i = 0; i < pkgs.size(); i++)
+    if (rep[i] == i)
+      wrt.package(std::get<0>(pkgs[i]), std::get<1>(pkgs[i]),
+                  std::get<2>(pkgs[i]), "");
+  rewrite(deps, id, false, true);
+  for (auto& r : deps)
+    wrt.dependency(r.first, r.second, "");
+  rewrite(confs, id, true, true);
+  for (auto& r : confs)
+    wrt.conflict(r.first, r.second, "");
+  for (auto& g : groups)
+    wrt.atMostOne(g, "");
+  rewrite(pvds, id, false, true);
+  for (auto& r : pvds)
+    wrt.provides(r.first, r.second, "");
+  clear();
+}
@@ -0,0 +1,161 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__MERGE__HH__
+#define __KCUDF__MERGE__HH__
+
+#include <kcudf/kcudf.hh>
+#include <kcudf/swriter.hh>
+
+/**
+ * \file Merging of equivalent packages.
+ *
+ * Two packages are equivalent when they have the same keep and install flags
+ * and the same dependencies, dependers, conflicts, provides and providers
+ * (a relation of a package with itself is considered the same for all of
+ * them). Packages in at-most-one groups are never merged.
+ *
+ * Every class of equivalent packages is replaced by one representative. A
+ * solution of the merged problem is expanded back by giving all the members
+ * the value of the representative; when the members are not installed and
+ * nothing depends directly on them, installing the representative alone is
+ * enough and the other members stay uninstalled.
+ */
+
+/**
+ * \brief Classes of merged packages.
+ */
+class KCudfMerging {
+public:
+  /// A class: representative, whether all members follow it, members
+  struct Class {
+    /// Representative
+    unsigned int rep;
+    /// Whether the members are installed with the representative
+    bool all;
+    /// Members (without the representative)
+    std::vector<unsigned int> members;
+  };
+private:
+  /// Index in \a cls of every representative
+  std::map<unsigned int, unsigned int> reps;
+  /// Classes
+  std::vector<Class> cls;
+public:
+  /// Adds class \a c
+  void add(const Class& c);
+  /// Number of classes
+  unsigned int size(void) const {
+    return cls.size();
+  }
+  /// Classes
+  const std::vector<Class>& classes(void) const {
+    return cls;
+  }
+  /// Number of merged packages (members of all the classes)
+  unsigned int merged(void) const;
+  /// Returns the class of representative \a p or NULL
+  const Class* find(unsigned int p) const;
+  /**
+   * \brief Writes the classes on \a os, one per line:
+   * "representative all|one member1 ... membern".
+   */
+  void write(std::ostream& os) const;
+  /// Reads the classes written by \a write from \a is
+  void read(std::istream& is);
+};
+
+/**
+ * \brief Writer that merges the equivalent packages of the problem it
+ * receives before passing it to \a wrt.
+ *
+ * The problem is buffered and written by \a flush, in the order packages,
+ * dependencies, conflicts, at-most-one groups and provides.
+ */
+class KCudfMergeWriter final : public KCudfBufferWriter {
+public:
+  /// Constructor for a writer passing the merged problem to \a w
+  KCudfMergeWriter(KCudfWriter& w);
+  /// Destructor
+  virtual ~KCudfMergeWriter(void);
+  /**
+   * \brief Merges the equivalent packages, stores their classes in \a m and
+   * writes the merged problem. It can only be called once.
+   */
+  void flush(KCudfMerging& m);
+};
+
+/**
+ * \brief Writer that expands the packages merged in \a m before passing them
+ * to \a wrt.
+ *
+ * It is used to apply the solution of a merged problem, for instance with
+ * \a readPackages or \a readModel. Relations are passed unchanged.
+ */
+template <class Writer>
+class KCudfExpandWriter final : public KCudfWriter {
+private:
+  /// Writer receiving the expanded packages
+  Writer& wrt;
+  /// Merged classes
+  const KCudfMerging& m;
+public:
+  /// Constructor
+  KCudfExpandWriter(Writer& w, const KCudfMerging& mg) : wrt(w), m(mg) {}
+  void package(unsigned int p, bool keep, bool install, const char* desc) {
+    wrt.package(p, keep, install, desc);
+    const KCudfMerging::Class* c = m.find(p);
+    if (c != NULL)
+      for (unsigned int q : c->members)
+        wrt.package(q, keep, install && c->all, desc);
+  }
+  /// Only the representative lacks a safe provider, not its members
+  void unprovided(unsigned int p) {
+    wrt.unprovided(p);
+  }
+  void dependency(unsigned int p, unsigned int q, const char* desc) {
+    wrt.dependency(p, q, desc);
+  }
+  void conflict(unsigned int p, unsigned int q, const char* desc) {
+    wrt.conflict(p, q, desc);
+  }
+  void provides(unsigned int p, unsigned int q, const char* desc) {
+    wrt.provides(p, q, desc);
+  }
+  void atMostOne(const std::vector<unsigned int>& g, const char* desc) {
+    wrt.atMostOne(g, desc);
+  }
+};
+
+#endif
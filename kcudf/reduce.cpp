@@ -35,8 +35,15 @@
  */
 
 #include <cassert>
+#include <cstdint>
 #include <sstream>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <boost/graph/strong_components.hpp>
 #include <kcudf/reduce.hh>
+#include <kcudf/solver.hh>
 
 namespace std {
   template <typename IteratorPair>
@@ -57,7 +64,13 @@ using namespace std;
 
 ReducerStats::ReducerStats(void)
   : pkgs(0), pkg_srch(0), pkg_is(0), pkg_slvd(0), pkg_nis(0), deps(0), confs(0),
-  pvds(0), solution(false), fail(false) {}
+  pvds(0), groups(0), solution(false), fail(false), cancelled(false), todo1_max(0), todo2_max(0),
+  dup_tasks(0), schedule(WLP_FIFO), tasks(0), ucp_deps(0), deps_trimmed(0), solver(false), solver_conflicts(0),
+  solver_decisions(0), probes(0), probe_failed(0), probe_fixed(0) {
+  std::fill(ops, ops + PK_NOPS, 0);
+  std::fill(ops_eff, ops_eff + PK_NOPS, 0);
+  std::fill(&trans[0][0], &trans[0][0] + PKR_NSTATES * PK_NSTATEOPS, 0);
+}
 
 std::ostream& operator <<(std::ostream& os, const ReducerStats& st) {
   if (st.fail) {
@@ -66,6 +79,7 @@ std::ostream& operator <<(std::ostream& os, const ReducerStats& st) {
   }
   os <<  "General stats:" << endl
       << "\tSolution:\t" << (st.solution ? "yes" : "no") << endl
+      << "\tCancelled:\t" << (st.cancelled ? "yes" : "no") << endl
       << "Package stats:" << endl
       << "\tInitial packages:\t" << st.pkgs << endl
       << "\tPackages in search:\t" << st.pkg_srch << endl
@@ -75,10 +89,72 @@ std::ostream& operator <<(std::ostream& os, const ReducerStats& st) {
       << "Package relations:" << endl
       << "\tDependencies:\t" << st.deps << endl
       << "\tConflicts:\t" << st.confs << endl
-      << "\tProvides:\t" << st.pvds << endl;
+      << "\tProvides:\t" << st.pvds << endl
+      << "\tAt-most-one groups:\t" << st.groups << endl
+      << "Profile:" << endl
+      << "\tOperations (effective):\t";
+  for (unsigned int op = 0; op < PK_NOPS; op++)
+    os << (op == 0 ? "" : ", ") << st.ops[op] << " (" << st.ops_eff[op] << ")";
+  os << endl
+     << "\tTodo lists high-water:\t" << st.todo1_max << ", " << st.todo2_max << endl
+     << "\tTasks (" << policyName(st.schedule) << "):\t" << st.tasks << endl
+     << "\tDuplicate tasks:\t" << st.dup_tasks << endl
+     << "\tDependencies added by UCP:\t" << st.ucp_deps << endl
+     << "\tDependencies trimmed:\t" << st.deps_trimmed << endl
+     << "\tBuilt-in solver:\t" << (st.solver ? "yes" : "no") << " ("
+     << st.solver_conflicts << " conflicts, " << st.solver_decisions
+     << " decisions)" << endl
+     << "\tProbes (failed):\t" << st.probes << " (" << st.probe_failed << ")" << endl
+     << "\tPackages fixed by probing:\t" << st.probe_fixed << endl;
+  for (const PhaseStats& ph : st.phases)
+    os << "\tTime " << ph.name << ":\t" << ph.secs << endl;
   return os;
 }
 
+void writeJson(std::ostream& os, const ReducerStats& st) {
+  static const char* op_names[PK_NOPS] =
+    {"MU", "MI", "CI", "CU", "UCP", "USP", "UPD"};
+  static const char* st_names[PKR_NSTATES] = {"CU", "CI", "MU", "MI", "SR"};
+  os << "{\n"
+     << "  \"fail\": " << (st.fail ? "true" : "false") << ",\n"
+     << "  \"solution\": " << (st.solution ? "true" : "false") << ",\n"
+     << "  \"cancelled\": " << (st.cancelled ? "true" : "false") << ",\n"
+     << "  \"packages\": " << st.pkgs << ",\n"
+     << "  \"search\": " << st.pkg_srch << ",\n"
+     << "  \"solved\": " << st.pkg_slvd << ",\n"
+     << "  \"not_interesting\": " << st.pkg_nis << ",\n"
+     << "  \"interesting\": " << st.pkg_is << ",\n"
+     << "  \"operations\": {";
+  for (unsigned int op = 0; op < PK_NOPS; op++)
+    os << (op == 0 ? "" : ",") << "\n    \"" << op_names[op] << "\": {\"runs\": "
+       << st.ops[op] << ", \"effective\": " << st.ops_eff[op] << "}";
+  os << "\n  },\n"
+     << "  \"transitions\": {";
+  for (unsigned int s = 0; s < PKR_NSTATES; s++) {
+    os << (s == 0 ? "" : ",") << "\n    \"" << st_names[s] << "\": {";
+    for (unsigned int op = 0; op < PK_NSTATEOPS; op++)
+      os << (op == 0 ? "" : ", ") << "\"" << op_names[op] << "\": " << st.trans[s][op];
+    os << "}";
+  }
+  os << "\n  },\n"
+     << "  \"todo1_max\": " << st.todo1_max << ",\n"
+     << "  \"todo2_max\": " << st.todo2_max << ",\n"
+     << "  \"schedule\": {\"policy\": \"" << policyName(st.schedule)
+     << "\", \"tasks\": " << st.tasks << "},\n"
+     << "  \"duplicate_tasks\": " << st.dup_tasks << ",\n"
+     << "  \"ucp_dependencies\": " << st.ucp_deps << ",\n"
+     << "  \"trimmed_dependencies\": " << st.deps_trimmed << ",\n"
+     << "  \"solver\": {\"used\": " << (st.solver ? "true" : "false")
+     << ", \"conflicts\": " << st.solver_conflicts
+     << ", \"decisions\": " << st.solver_decisions << "},\n"
+     << "  \"probing\": {\"probes\": " << st.probes
+     << ", \"failed\": " << st.probe_failed
+     << ", \"fixed\": " << st.probe_fixed << "},\n"
+     << "  \"phases\": ";
+  writeJson(os, st.phases);
+  os << "\n}\n";
+}
+
 #ifndef NDEBUG
 std::ostream& operator<< (std::ostream& o,const PKR_STATE st) {
   switch (st) {
@@ -121,10 +197,13 @@ PKR_STATE KCudfReducer::tf[5][4] =
     {PKR_AB, PKR_AB, PKR_SR, PKR_SR}  // PKR_SR
   };
 
-KCudfReducer::KCudfReducer(void) : GraphWriter() {}
+KCudfReducer::KCudfReducer(void)
+  : GraphWriter(), prof(false), solveBelow(0), probeThreads(0), trim(false),
+    cancelTk(NULL) {}
 
 KCudfReducer::KCudfReducer(std::istream& paranoid)
-: GraphWriter() {
+: GraphWriter(), prof(false), solveBelow(0), probeThreads(0), trim(false),
+  cancelTk(NULL) {
   int package;
   std::string line;
   while (paranoid.good()) {
@@ -137,6 +216,16 @@ KCudfReducer::KCudfReducer(std::istream& paranoid)
 
 KCudfReducer::~KCudfReducer(void) {}
 
+void KCudfReducer::collapsed(const KCudfMerging& m) {
+  for (const KCudfMerging::Class& c : m.classes())
+    for (unsigned int p : c.members)
+      if (init_search.count(p) > 0) {
+        if (init_search.insert(c.rep).second)
+          addTask(PK_CI, c.rep, TD_2);
+        break;
+      }
+}
+
 void KCudfReducer::package(unsigned int p, bool keep, bool install, const char* d) {
   // The initial state o each package depends on its state in the system.
   PKR_STATE st;
@@ -162,29 +251,64 @@ void KCudfReducer::package(unsigned int p, bool keep, bool install, const char*
 
 KCudfReducer::task_t
 KCudfReducer::nextTask(void) {
-  if (!todo1.empty()) {
-    task_t t = todo1.front();
-    todo1.pop_front();
-    return t;
-  }
-  task_t t = todo2.front();
-  todo2.pop_front();
+  task_t t = !todo1.empty() ? todo1.pop() : todo2.pop();
+  if (prof)
+    pending[t]--;
+  st.ops[t.first]++;
+  st.tasks++;
   return t;
 }
 
+unsigned int
+KCudfReducer::taskKey(PK_OP op, unsigned int pk) const {
+  switch (st.schedule) {
+  case WLP_DEGREE:
+    return degree(pk);
+  case WLP_BUCKET:
+    return op;
+  default:
+    return 0;
+  }
+}
+
 inline void
 KCudfReducer::addTask(PK_OP op, unsigned int pk, KCudfReducer::TD_LST t) {
   task_t tk(op,pk);
+  if (prof && pending[tk]++ > 0)
+    st.dup_tasks++;
   switch (t) {
   case TD_1:
-    todo1.push_back(tk);
+    todo1.push(tk, 0);
+    st.todo1_max = std::max(st.todo1_max, todo1.size());
     break;
   case TD_2:
-    todo2.push_back(tk);
+    todo2.push(tk, taskKey(op, pk));
+    st.todo2_max = std::max(st.todo2_max, todo2.size());
     break;
   }
 }
 
+void
+KCudfReducer::addGroupTask(PK_OP op, unsigned int pk, KCudfReducer::TD_LST t,
+                           std::vector<group_src_t>& src) {
+  const unsigned int none = std::numeric_limits<unsigned int>::max();
+  for (unsigned int g : groups(pk)) {
+    group_src_t& s = src[g];
+    if (s.first == pk || s.second == pk || s.second != none) {
+      // every member already received the operation
+      continue;
+    } else if (s.first == none) {
+      s.first = pk;
+      for (unsigned int p : group(g))
+        if (p != pk) addTask(op, p, t);
+    } else {
+      // only the first source did not receive it
+      s.second = pk;
+      addTask(op, s.first, t);
+    }
+  }
+}
+
 inline bool
 KCudfReducer::workTodo(void) const {
   return !todo1.empty() || !todo2.empty();
@@ -192,14 +316,13 @@ KCudfReducer::workTodo(void) const {
 
 #ifndef NDEBUG
 void KCudfReducer::printWork(void) const {
-  std::cerr << "Work in TODO1" << std::endl;
-  for (task_t t : todo1) {
+  auto print = [](const task_t& t) {
     std::cerr << "\tOp: " << t.first << " Pk: " << t.second << std::endl;
-  }
+  };
+  std::cerr << "Work in TODO1" << std::endl;
+  todo1.forEach(print);
   std::cerr << "Work in TODO2" << std::endl;
-  for (task_t t : todo2) {
-    std::cerr << "\tOp: " << t.first << " Pk: " << t.second << std::endl;
-  }
+  todo2.forEach(print);
 }
 #endif
 
@@ -233,6 +356,7 @@ KCudfReducer::update(unsigned int pid) {
     for (unsigned int p : conflicts(pid)) {
       addTask(PK_MU, p, TD_1);
     }
+    addGroupTask(PK_MU, pid, TD_1, grp_mu);
     break;
   case PKR_MU:
     /*
@@ -254,6 +378,7 @@ KCudfReducer::update(unsigned int pid) {
     for (unsigned int p : conflicts(pid)) {
       addTask(PK_CU, p, TD_2);
     }
+    addGroupTask(PK_CU, pid, TD_2, grp_cu);
     break;
   case PKR_CU:
     /*
@@ -281,6 +406,7 @@ KCudfReducer::update(unsigned int pid) {
     for (unsigned int p : conflicts(pid)) {
       addTask(PK_CU, p, TD_2);
     }
+    addGroupTask(PK_CU, pid, TD_2, grp_cu);
     for (unsigned int p : dependers(pid)) {
       addTask(PK_CU, p, TD_2);
     }
@@ -293,6 +419,9 @@ KCudfReducer::update(unsigned int pid) {
 
 KCudfReducer::RD_OUT KCudfReducer::process(void) {
   // initialization
+  const unsigned int none = std::numeric_limits<unsigned int>::max();
+  grp_mu.assign(numGroups(), make_pair(none,none));
+  grp_cu.assign(numGroups(), make_pair(none,none));
   for (unsigned int pid : packages()) {
     unsigned int c = 0;
     unsigned int s =0;
@@ -308,6 +437,10 @@ KCudfReducer::RD_OUT KCudfReducer::process(void) {
   }
   // reduction
   while (workTodo()) {
+    if ((st.tasks & 1023) == 0 && interrupted()) {
+      st.pkgs = numPackages();
+      return RDO_CANCEL;
+    }
     PK_OP op;              // operation
     unsigned int pkgId;    // id of the package
     tie(op,pkgId) = nextTask();
@@ -315,16 +448,20 @@ KCudfReducer::RD_OUT KCudfReducer::process(void) {
 
     if (op == PK_MU || op == PK_MI || op == PK_CI || op == PK_CU) {
       PKR_STATE nextState = tf[currState][op];
+      st.trans[currState][op]++;
       if (nextState == PKR_FL) {
         std::stringstream ss;
-        ss << pkgId << ": TF(" << currState << "," << op <<"): "
-            << nextState << std::endl;
+        ss << "package " << pkgId << ": operation " << op
+           << " is not allowed in state " << currState
+           << " (TF(" << currState << "," << op << ") = " << nextState
+           << ")";
         st.fail = true;
         st.failure = ss.str();
         return RDO_FAIL;
       }
       assert(nextState != PKR_AB);
       if (currState != nextState) {
+        st.ops_eff[op]++;
         if (!isSP(currState) && isSP(nextState))
           for (unsigned int p : provides(pkgId)) {
             assert(sp.count(p) > 0);
@@ -351,23 +488,33 @@ KCudfReducer::RD_OUT KCudfReducer::process(void) {
         update(pkgId);
       }
     } else if (op == PK_UCP) {
-      if (cp.at(pkgId) == 0)
+      bool eff = false;
+      if (cp.at(pkgId) == 0) {
+        // effective only if the package is not uninstalled yet
+        eff = state(pkgId) != PKR_MU;
         addTask(PK_MU, pkgId, TD_1);
+      }
       if (cp.at(pkgId) == 1) {
         for (unsigned int p : providers(pkgId)) {
           if (isCP(state(p)) && !dependency(pkgId,p)) {
             dependency(pkgId,p,NULL);
+            st.ucp_deps++;
+            eff = true;
             addTask(PK_UPD, p, TD_1);
             addTask(PK_UPD, pkgId, TD_1);
           }
         }
       }
+      if (eff)
+        st.ops_eff[op]++;
     } else if (op == PK_USP && sp.at(pkgId) == 0 && isSPI(state(pkgId))) {
+      st.ops_eff[op]++;
       for (unsigned int p : providers(pkgId)) {
         addTask(PK_CI, p, TD_2);
       }
       addTask(PK_CU, pkgId, TD_2);
     } else if (op == PK_UPD) {
+      st.ops_eff[op]++;
       update(pkgId);
       addTask(PK_UCP, pkgId, TD_1);
       addTask(PK_USP, pkgId, TD_2);
@@ -427,6 +574,10 @@ void KCudfReducer::incDeps(unsigned int pkg, KCudfWriter& wrt) {
     p_st = state(p);
     if (p_st == PKR_SR) {
       //if (id != p) rep_deps++;  // avoid counting self dependencies
+      if (trimmed.count(rel_type(pkg, p)) > 0) {
+        st.deps_trimmed++;
+        continue;
+      }
       wrt.dependency(pkg, p, "DEP-betweenSR");
       st.deps++;
     } else {
@@ -445,8 +596,11 @@ void KCudfReducer::incConfs(unsigned int pkg, KCudfWriter& wrt) {
   for (unsigned int p: conflicts(pkg)) {
     p_st = state(p);
     if (p_st == PKR_SR) {
-      wrt.conflict(pkg, p, "CONF-betweenSR");
-      st.confs++;
+      // the conflict is reported by both ends, write it only once
+      if (pkg <= p) {
+        wrt.conflict(pkg, p, "CONF-betweenSR");
+        st.confs++;
+      }
     } else {
       assert(p_st == PKR_CU || p_st == PKR_MU);
     }
@@ -476,17 +630,396 @@ void KCudfReducer::incPvdrs(unsigned int pkg, KCudfWriter& wrt) {
   }
 }
 
+bool KCudfReducer::related(unsigned int pkg) const {
+  for (unsigned int p : dependencies(pkg))
+    if (state(p) == PKR_SR) return true;
+  for (unsigned int p : conflicts(pkg))
+    if (state(p) == PKR_SR) return true;
+  for (unsigned int p : provides(pkg))
+    if (state(p) == PKR_SR) return true;
+  return false;
+}
+
+void KCudfReducer::incGroups(KCudfWriter& wrt) {
+  for (unsigned int g = 0; g < numGroups(); g++) {
+    std::vector<unsigned int> srch;
+    for (unsigned int p : group(g)) {
+      PKR_STATE p_st = state(p);
+      if (p_st == PKR_SR)
+        srch.push_back(p);
+    }
+    if (srch.size() > 1) {
+#ifndef NDEBUG
+      for (unsigned int p : group(g))
+        assert(state(p) == PKR_SR || state(p) == PKR_CU || state(p) == PKR_MU);
+#endif
+      wrt.atMostOne(srch, "AMO-betweenSR");
+      st.groups++;
+    }
+  }
+}
+
 KCudfReducer::RD_OUT
 KCudfReducer::reduce(KCudfWriter& solved, KCudfWriter& search) {
   cout << "*** Reducing ***" << endl;
 
-  RD_OUT pr = process();
+  RD_OUT pr;
+  {
+    PhaseTimer t(st.phases, "process");
+    pr = process();
+  }
 
-  if (pr == RDO_FAIL) {
-    st.failure = true;
+  // process already described the failure in the statistics
+  if (pr == RDO_FAIL)
     return RDO_FAIL;
+  if (pr == RDO_CANCEL)
+    return RDO_CANCEL;
+
+  if (probeThreads > 0) {
+    PhaseTimer t(st.phases, "probe");
+    RD_OUT r = probe();
+    if (r != RDO_SEARCH)
+      return r;
+  }
+  if (interrupted())
+    return RDO_CANCEL;
+
+  RD_OUT r;
+  {
+    PhaseTimer t(st.phases, "output");
+    r = conclude(solved, search);
+  }
+  cout << "*** Reducing [done]***" << endl;
+  return r;
+}
+
+KCudfReducer::RD_OUT
+KCudfReducer::conclude(KCudfWriter& solved, KCudfWriter& search) {
+  unsigned int ns = numSearch();
+  if (ns > 0 && ns <= solveBelow) {
+    KCudfWriter none;
+    KCudfSolver slv;
+    KCudfSolver::SOLVE_OUT so;
+    {
+      PhaseTimer ts(st.phases, "solve");
+      output(none, slv);
+      so = slv.solve();
+    }
+    st.solver_conflicts = slv.conflicts();
+    st.solver_decisions = slv.decisions();
+    if (so == KCudfSolver::SO_UNSAT) {
+      st.fail = true;
+      st.failure = "the search part has no solution";
+      return RDO_FAIL;
+    }
+    if (so == KCudfSolver::SO_SAT) {
+      // the statistics describe the reduced problem, they are counted once
+      ReducerStats counted(st);
+      output(solved, none);
+      st = counted;
+      slv.solution(solved, "solver");
+      st.solver = true;
+      st.solution = true;
+      return RDO_SOL;
+    }
+    // too hard for the built-in solver
+  }
+
+  if (output(solved, search) > 0)
+    return RDO_SEARCH;
+  st.solution = true;
+  return RDO_SOL;
+}
+
+PKR_STATE KCudfReducer::probed(unsigned int p, const overlay_t& ov) const {
+  switch (PKR_STATE s = state(p)) {
+  case PKR_CI: return PKR_MI;
+  case PKR_CU: return PKR_MU;
+  case PKR_SR: {
+    overlay_t::const_iterator t = ov.find(p);
+    return t == ov.end() ? PKR_SR : t->second;
+  }
+  default: return s;
   }
+}
 
+bool KCudfReducer::propagate(PK_OP op, unsigned int p, overlay_t& ov) const {
+  assert(op == PK_MI || op == PK_MU);
+  /*
+    Only installed packages without a safe provider need one of their
+    candidate providers: returns the remaining one when there is exactly one
+    and it is still undecided, none if it is already decided and fails when
+    there is no candidate left.
+  */
+  const unsigned int none = std::numeric_limits<unsigned int>::max();
+  auto provider = [&](unsigned int q, unsigned int& r) -> bool {
+    unsigned int c = 0;
+    r = none;
+    for (unsigned int pvdr : providers(q)) {
+      PKR_STATE s = probed(pvdr, ov);
+      if (s == PKR_MI) { r = none; return true; }
+      if (s == PKR_SR) { c++; r = pvdr; }
+    }
+    if (c != 1) r = none;
+    return c > 0;
+  };
+  std::vector<task_t> work(1, task_t(op,p));
+  while (!work.empty()) {
+    tie(op,p) = work.back();
+    work.pop_back();
+    const PKR_STATE currState = probed(p, ov);
+    // in the search part only must install and must uninstall are meaningful
+    const PKR_STATE nextState = currState != PKR_SR ? tf[currState][op] :
+      (op == PK_MI ? PKR_MI : PKR_MU);
+    if (nextState == PKR_FL)
+      return false;
+    if (currState == nextState)
+      continue;
+    ov[p] = nextState;
+    unsigned int r;
+    if (nextState == PKR_MI) {
+      for (unsigned int q : dependencies(p))
+        work.push_back(task_t(PK_MI, q));
+      for (unsigned int q : conflicts(p))
+        work.push_back(task_t(PK_MU, q));
+      for (unsigned int g : groups(p))
+        for (unsigned int q : group(g))
+          if (q != p) work.push_back(task_t(PK_MU, q));
+      if (sp.at(p) == 0 && numProviders(p) > 0) {
+        if (!provider(p, r))
+          return false;
+        if (r != none) work.push_back(task_t(PK_MI, r));
+      }
+    } else {
+      for (unsigned int q : dependers(p))
+        work.push_back(task_t(PK_MU, q));
+      for (unsigned int q : provides(p))
+        if (sp.at(q) == 0 && probed(q, ov) == PKR_MI) {
+          if (!provider(q, r))
+            return false;
+          if (r != none) work.push_back(task_t(PK_MI, r));
+        }
+    }
+  }
+  return true;
+}
+
+KCudfReducer::RD_OUT KCudfReducer::probe(void) {
+  // candidates in decreasing order of degree
+  std::vector<std::pair<unsigned int, unsigned int> > deg;
+  for (unsigned int p : packages())
+    if (state(p) == PKR_SR) {
+      unsigned int d = numDependencies(p) + numDependers(p) + numConflicts(p);
+      for (unsigned int g : groups(p))
+        d += group(g).size() - 1;
+      deg.push_back(make_pair(d, p));
+    }
+  std::sort(deg.begin(), deg.end(),
+            [](const std::pair<unsigned int, unsigned int>& a,
+               const std::pair<unsigned int, unsigned int>& b) {
+              return a.first > b.first || (a.first == b.first && a.second < b.second);
+            });
+  std::vector<unsigned int> cand;
+  for (const std::pair<unsigned int, unsigned int>& d : deg)
+    cand.push_back(d.second);
+
+  // probes only read the reducer, the failures are applied between rounds
+  std::vector<PK_OP> fix;
+  do {
+    fix.assign(cand.size(), PK_UPD);
+    std::atomic<size_t> next(0);
+    std::atomic<unsigned long> probes(0);
+    auto run = [&](void) {
+      overlay_t ov;
+      for (size_t i = next++; i < cand.size(); i = next++) {
+        if (expired()) break;
+        const unsigned int p = cand[i];
+        if (state(p) != PKR_SR) continue;
+        probes += 2;
+        ov.clear();
+        bool mi = propagate(PK_MI, p, ov);
+        ov.clear();
+        bool mu = propagate(PK_MU, p, ov);
+        if (!mi) fix[i] = PK_MU;
+        else if (!mu) fix[i] = PK_MI;
+      }
+    };
+    const unsigned int n =
+      std::min<size_t>(probeThreads, std::max<size_t>(cand.size(), 1));
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < n; t++)
+      workers.push_back(std::thread(run));
+    run();
+    for (std::thread& w : workers)
+      w.join();
+    st.probes += probes;
+    // the failures of an incomplete round are not applied
+    if (interrupted())
+      return RDO_CANCEL;
+
+    bool fixed = false;
+    std::vector<unsigned int> left;
+    for (size_t i = 0; i < cand.size(); i++) {
+      const unsigned int p = cand[i];
+      if (fix[i] == PK_UPD) {
+        if (state(p) == PKR_SR) left.push_back(p);
+        continue;
+      }
+      /*
+        The probes of a round see the states before it, every package fixed
+        since then only adds constraints so the failure still holds.
+      */
+      st.probe_failed++;
+      overlay_t ov;
+      if (!propagate(fix[i], p, ov)) {
+        std::stringstream ss;
+        ss << p << ": both probes fail" << std::endl;
+        st.fail = true;
+        st.failure = ss.str();
+        return RDO_FAIL;
+      }
+      for (const overlay_t::value_type& f : ov) {
+        if (f.second == PKR_MI) {
+          for (unsigned int q : provides(f.first))
+            sp[q] += 1;
+        } else {
+          for (unsigned int q : provides(f.first))
+            cp[q] -= 1;
+        }
+        state(f.first, f.second);
+        st.probe_fixed++;
+      }
+      fixed = true;
+    }
+    if (!fixed) break;
+    cand.swap(left);
+  } while (!cand.empty());
+  return RDO_SEARCH;
+}
+
+namespace {
+  /// Largest number of components for which the reachability uses bitsets
+  const unsigned int TR_BITSET_MAX = 1 << 14;
+  /// Components visited by the bounded search for each dependency
+  const unsigned int TR_SEARCH_MAX = 1024;
+}
+
+void KCudfReducer::redundantDeps(std::set<rel_type>& rd) const {
+  KCUDF_TRACE_SCOPE("transitive reduction");
+  // dependency graph between the packages in search state
+  std::vector<unsigned int> ids;
+  std::map<unsigned int, unsigned int> idx;
+  for (unsigned int p : packages())
+    if (state(p) == PKR_SR) {
+      idx[p] = ids.size();
+      ids.push_back(p);
+    }
+  typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> graph_t;
+  graph_t g(ids.size());
+  std::vector<rel_type> edges;
+  for (unsigned int i = 0; i < ids.size(); i++)
+    for (unsigned int q : dependencies(ids[i])) {
+      std::map<unsigned int, unsigned int>::const_iterator j = idx.find(q);
+      if (j != idx.end() && j->second != i) {
+        boost::add_edge(i, j->second, g);
+        edges.push_back(rel_type(i, j->second));
+      }
+    }
+  std::vector<unsigned int> comp(ids.size());
+  const unsigned int nc =
+    boost::strong_components(g, boost::make_iterator_property_map(
+                               comp.begin(), boost::get(boost::vertex_index, g)));
+
+  // graph of the components, numbered in reverse topological order
+  std::vector<std::vector<unsigned int> > succ(nc);
+  for (const rel_type& e : edges) {
+    const unsigned int a = comp[e.first], b = comp[e.second];
+    if (a != b) {
+      assert(b < a);
+      succ[a].push_back(b);
+    }
+  }
+  for (std::vector<unsigned int>& s : succ) {
+    std::sort(s.begin(), s.end());
+    s.erase(std::unique(s.begin(), s.end()), s.end());
+  }
+
+  // edges between components with a longer path between them
+  std::set<rel_type> red;
+  if (nc <= TR_BITSET_MAX) {
+    // components reachable from every component through at least one edge
+    const size_t w = (nc + 63) / 64;
+    std::vector<uint64_t> reach(nc * w, 0);
+    std::vector<uint64_t> via(w);
+    for (unsigned int c = 0; c < nc; c++) {
+      std::fill(via.begin(), via.end(), 0);
+      for (unsigned int d : succ[c])
+        for (size_t k = 0; k < w; k++)
+          via[k] |= reach[d * w + k];
+      for (unsigned int d : succ[c]) {
+        if ((via[d / 64] >> (d % 64)) & 1)
+          red.insert(rel_type(c, d));
+        via[d / 64] |= uint64_t(1) << (d % 64);
+      }
+      std::copy(via.begin(), via.end(), reach.begin() + c * w);
+    }
+  } else {
+    // only components with a greater number can reach d
+    const unsigned int none = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> seen(nc, none);
+    std::vector<unsigned int> work;
+    unsigned int mark = 0;
+    for (unsigned int c = 0; c < nc; c++)
+      for (unsigned int d : succ[c]) {
+        work.clear();
+        for (unsigned int x : succ[c])
+          if (x > d) {
+            seen[x] = mark;
+            work.push_back(x);
+          }
+        unsigned int visited = 0;
+        bool found = false;
+        for (size_t i = 0; i < work.size() && !found && visited < TR_SEARCH_MAX;
+             i++, visited++)
+          for (unsigned int y : succ[work[i]]) {
+            if (y == d) {
+              found = true;
+              break;
+            }
+            if (y > d && seen[y] != mark) {
+              seen[y] = mark;
+              work.push_back(y);
+            }
+          }
+        if (found)
+          red.insert(rel_type(c, d));
+        mark++;
+      }
+  }
+
+  // dependencies: the redundant ones and all but one between two components
+  std::set<rel_type> kept;
+  for (const rel_type& e : edges) {
+    const rel_type ce(comp[e.first], comp[e.second]);
+    if (ce.first == ce.second)
+      continue;
+    if (red.count(ce) > 0 || !kept.insert(ce).second)
+      rd.insert(rel_type(ids[e.first], ids[e.second]));
+  }
+}
+
+unsigned int KCudfReducer::numSearch(void) const {
+  unsigned int n = 0;
+  for (unsigned int pkg: packages()) {
+    PKR_STATE s = state(pkg);
+    if (s == PKR_SR || ((s == PKR_MI || s == PKR_CI) && sp.at(pkg) == 0))
+      n++;
+  }
+  return n;
+}
+
+unsigned int
+KCudfReducer::output(KCudfWriter& solved, KCudfWriter& search) {
   set<unsigned int> slvd;
   set<unsigned int> sp0;
   set<unsigned int> srch;
@@ -511,6 +1044,9 @@ KCudfReducer::reduce(KCudfWriter& solved, KCudfWriter& search) {
         sp0.insert(sp0.end(),pkg);
         st.pkg_is++;
         st.pkg_srch++;
+      } else if (related(pkg)) {
+        // its relations go to the search part, so it is declared there too
+        search.package(pkg, true, true, "MI - CI");
       }
       /*
         Packages with any sp are considered solved but go in both
@@ -519,6 +1055,8 @@ KCudfReducer::reduce(KCudfWriter& solved, KCudfWriter& search) {
         included in the solved part.
       */
       solved.package(pkg, true, true, "MI - CI");
+      if (sp.at(pkg) == 0)
+        solved.unprovided(pkg);
       slvd.insert(slvd.end(),pkg);
       st.pkg_slvd++;
       break;
@@ -547,6 +1085,9 @@ KCudfReducer::reduce(KCudfWriter& solved, KCudfWriter& search) {
   }
 
   // output information about relations
+  trimmed.clear();
+  if (trim)
+    redundantDeps(trimmed);
   for (unsigned int pkg : packages()) {
     PKR_STATE pkg_st = state(pkg);
     switch (pkg_st) {
@@ -587,16 +1128,68 @@ KCudfReducer::reduce(KCudfWriter& solved, KCudfWriter& search) {
       break;
     }
   }
+  // At-most-one groups
+  incGroups(search);
 
-  cout << "*** Reducing [done]***" << endl;
+  return srch.size();
+}
 
-  if ( srch.size() > 0)
-    return RDO_SEARCH;
-  st.solution = true;
-  return RDO_SOL;
+void KCudfReducer::solverThreshold(unsigned int n) {
+  solveBelow = n;
+}
+
+void KCudfReducer::probing(unsigned int n) {
+  probeThreads = n;
+}
+
+void KCudfReducer::transitiveReduction(bool on) {
+  trim = on;
+}
+
+void KCudfReducer::scheduling(WL_POLICY p) {
+  st.schedule = p;
+  // the must operations stay fifo, their order changes the fixed point
+  todo2.policy(p);
+}
+
+void KCudfReducer::cancellation(const CancelToken* ct) {
+  cancelTk = ct;
+}
+
+bool KCudfReducer::expired(void) const {
+  return cancelTk != NULL && cancelTk->expired();
+}
+
+bool KCudfReducer::interrupted(void) {
+  if (expired())
+    st.cancelled = true;
+  return st.cancelled;
 }
 
 const ReducerStats& KCudfReducer::stats(void) const {
   return st;
 }
 
+void KCudfReducer::profile(bool on) {
+  prof = on;
+}
+
+void KCudfReducer::memory(MemoryReport& r) const {
+  GraphWriter::memory(r);
+  r.add("KCudfReducer::pkg_st", pkg_st.size(), heapBytes(pkg_st));
+  r.add("KCudfReducer::sp", sp.size(), heapBytes(sp));
+  r.add("KCudfReducer::cp", cp.size(), heapBytes(cp));
+  r.add("KCudfReducer todo lists", todo1.size() + todo2.size(),
+        heapBytes(todo1) + heapBytes(todo2));
+  r.add("KCudfReducer todo lists (high-water)", st.todo1_max + st.todo2_max,
+        (st.todo1_max + st.todo2_max) *
+        (st.schedule == WLP_DEGREE ?
+         sizeof(std::tuple<unsigned int, unsigned long, task_t>) :
+         heapBlock(LIST_NODE + sizeof(task_t))));
+  r.add("KCudfReducer pending tasks", pending.size(), heapBytes(pending));
+  r.add("KCudfReducer groups", grp_mu.size() + grp_cu.size(),
+        heapBytes(grp_mu) + heapBytes(grp_cu));
+  r.add("KCudfReducer::init_search", init_search.size(), heapBytes(init_search));
+  r.add("KCudfReducer::trimmed", trimmed.size(), heapBytes(trimmed));
+}
+
@@ -37,8 +37,11 @@
 #ifndef __KCUDF__REDUCE__HH__
 #define __KCUDF__REDUCE__HH__
 
+#include <unordered_map>
 #include <kcudf/kcudf.hh>
 #include <kcudf/gwriter.hh>
+#include <kcudf/worklist.hh>
+#include <kcudf/merge.hh>
 
 /**
  * \brief Possible states for a package inside the reducer.
@@ -66,6 +69,13 @@ enum PK_OP {
   PK_UPD     ///> Update packages
 };
 
+/// Number of package states on which the transition function is defined
+const unsigned int PKR_NSTATES = PKR_SR + 1;
+/// Number of operations that change the state of a package
+const unsigned int PK_NSTATEOPS = PK_CU + 1;
+/// Number of operations
+const unsigned int PK_NOPS = PK_UPD + 1;
+
 #ifndef NDEBUG
 /// Output of package status
 std::ostream& operator<< (std::ostream& o,const PKR_STATE st);
@@ -96,12 +106,56 @@ public:
   unsigned int confs;
   /// Number of provides interesting to the solver
   unsigned int pvds;
+  /// Number of at-most-one groups interesting to the solver
+  unsigned int groups;
   /// A solution was find by the reducer
   bool solution;
   /// A failure was find by the reducer
   bool fail;
   /// Failure state
   std::string failure;
+  /// The reduction was cancelled or its deadline passed (see \a CancelToken)
+  bool cancelled;
+  /// Number of operations of each kind (indexed by \a PK_OP) run by the reducer
+  unsigned long ops[PK_NOPS];
+  /**
+   * \brief Number of operations of each kind that had some effect.
+   *
+   * For must/can operations this means that the state of the package
+   * changed. For the update operations it means that some dependency was
+   * added or that some task that changes the state of a package was added.
+   */
+  unsigned long ops_eff[PK_NOPS];
+  /// Number of times each entry of the transition function was applied
+  unsigned long trans[PKR_NSTATES][PK_NSTATEOPS];
+  /// Maximum size reached by the first todo list
+  size_t todo1_max;
+  /// Maximum size reached by the second todo list
+  size_t todo2_max;
+  /// Tasks added while an identical task was pending (only when profiling)
+  unsigned long dup_tasks;
+  /// Scheduling policy of the todo lists
+  WL_POLICY schedule;
+  /// Tasks run by the reducer, of every kind
+  unsigned long tasks;
+  /// Dependencies added by the update candidate providers operation
+  unsigned long ucp_deps;
+  /// Dependencies left out of the search part by the transitive reduction
+  unsigned long deps_trimmed;
+  /// The search part was solved by the built-in solver
+  bool solver;
+  /// Conflicts of the built-in solver
+  unsigned long solver_conflicts;
+  /// Decisions of the built-in solver
+  unsigned long solver_decisions;
+  /// Probes run on packages in search state
+  unsigned long probes;
+  /// Probes that reached a failure (the opposite state got fixed)
+  unsigned long probe_failed;
+  /// Packages in search state fixed by the probing stage
+  unsigned long probe_fixed;
+  /// Time spent processing the packages and writing the output
+  std::vector<PhaseStats> phases;
   /// Constructor
   ReducerStats(void);
 };
@@ -109,10 +163,16 @@ public:
 /// Output of reducer statistics to stream \a os.
 std::ostream& operator <<(std::ostream& os, const ReducerStats& st);
 
+/// Output \a st on \a os as a json object
+void writeJson(std::ostream& os, const ReducerStats& st);
+
 /**
  * \brief Reducer for kcudf specifications.
+ *
+ * The class is final so that \a read and \a KCudfTranslator::translate resolve
+ * the calls to the reducer at compile time.
  */
-class KCudfReducer : public GraphWriter {
+class KCudfReducer final : public GraphWriter {
 private:
   /// Transition function of the reducer
   static PKR_STATE tf[5][4];
@@ -120,10 +180,13 @@ private:
   void update(unsigned int pid);
   /// Type for tasks to be done
   typedef std::pair<PK_OP,unsigned int> task_t;
-  /// First todo list
-  std::list<task_t> todo1;
-  /// Second todo list
-  std::list<task_t> todo2;
+  /**
+   * \brief First todo list (must and update operations), always emptied
+   * before the second one. It is always fifo (see \a scheduling).
+   */
+  Worklist<task_t> todo1;
+  /// Second todo list (can operations), ordered by the scheduling policy
+  Worklist<task_t> todo2;
   /// Enumeration to identify the end list of a task
   enum TD_LST {
     TD_1, /// Task for the todo list 1
@@ -135,10 +198,57 @@ private:
   std::map<unsigned int, unsigned int> sp;
   /// Candidate providers for each package
   std::map<unsigned int, unsigned int> cp;
+  /// Type for the (at most two) members that propagated an operation on a group
+  typedef std::pair<unsigned int, unsigned int> group_src_t;
+  /// Members that propagated must uninstall on each at-most-one group
+  std::vector<group_src_t> grp_mu;
+  /// Members that propagated can uninstall on each at-most-one group
+  std::vector<group_src_t> grp_cu;
+  /**
+   * \brief Adds a task on list \a td to perform \a op on the packages sharing
+   * an at-most-one group with \a pk. Sources of every group are tracked in \a src.
+   *
+   * The operations propagated through groups (must and can uninstall) are
+   * idempotent, so every member has to receive them only once: the first
+   * source sends the task to all the other members and the second one sends it
+   * to the first. This keeps propagation linear in the size of the group.
+   */
+  void addGroupTask(PK_OP op, unsigned int pk, TD_LST td,
+                    std::vector<group_src_t>& src);
   /// Statistics of the reduction process
   ReducerStats st;
+  /// Whether tasks pending in the todo lists are tracked
+  bool prof;
+  /// Number of times each task is pending (only when profiling)
+  std::map<task_t, unsigned int> pending;
+  /// Largest search part solved by the built-in solver
+  unsigned int solveBelow;
+  /// Threads of the probing stage (0 disables it)
+  unsigned int probeThreads;
+  /// Whether implied dependencies are left out of the search part
+  bool trim;
+  /// Token checked during the reduction (NULL if there is none)
+  const CancelToken* cancelTk;
+  /// Tests whether the reduction has to stop
+  bool expired(void) const;
+  /**
+   * \brief Tests whether the reduction has to stop and, if so, records it in
+   * the statistics.
+   */
+  bool interrupted(void);
+  /// Dependencies of the search part implied by others (see \a transitiveReduction)
+  std::set<rel_type> trimmed;
+  /**
+   * \brief Stores in \a rd the dependencies between packages in search state
+   * that are implied by the other ones.
+   */
+  void redundantDeps(std::set<rel_type>& rd) const;
+  /// Type for the tentative states of a probe, on top of \a pkg_st
+  typedef std::unordered_map<unsigned int, PKR_STATE> overlay_t;
   /// Returns the next task to do.
   task_t nextTask(void);
+  /// Key of the task performing \a op on package \a pk for the scheduling policy
+  unsigned int taskKey(PK_OP op, unsigned int pk) const;
   /**
    * \brief Returns add a task on list \a td to perform operation \a
    * op on package \a pk
@@ -172,6 +282,7 @@ public:
     RDO_FAIL,   /// The problem has no solution
     RDO_SOL,    /// The problem has a solution an the reducer found it
     RDO_SEARCH, /// The problem has been reduced and search is needed
+    RDO_CANCEL, /// The reduction was cancelled before it finished
   };
 private:
   /**
@@ -194,6 +305,49 @@ private:
   void incPvds(unsigned int pkg, KCudfWriter& wrt);
   /// Write all the _providers_ relations of package \a pkg which are in search state
   void incPvdrs(unsigned int pkg, KCudfWriter& wrt);
+  /// Write the at-most-one groups restricted to the packages in search state
+  void incGroups(KCudfWriter& wrt);
+  /**
+   * \brief Tests whether package \a pkg has a dependency, conflict or provides
+   * relation with a package in search state.
+   */
+  bool related(unsigned int pkg) const;
+  /**
+   * \brief State of package \a p as seen by a probe with tentative states
+   * \a ov: solved packages are installed (\a PKR_MI) or not (\a PKR_MU).
+   */
+  PKR_STATE probed(unsigned int p, const overlay_t& ov) const;
+  /**
+   * \brief Propagates operation \a op (\a PK_MI or \a PK_MU) on package
+   * \a p over the search part, recording the new states in \a ov.
+   *
+   * Returns false if some package reaches \a PKR_FL. The reducer is not
+   * modified, so several probes can run at the same time.
+   */
+  bool propagate(PK_OP op, unsigned int p, overlay_t& ov) const;
+  /**
+   * \brief Probes both states of every package in search state and fixes the
+   * opposite one when a probe fails, until no probe fails.
+   *
+   * Returns \a RDO_FAIL when both probes of a package fail.
+   */
+  RD_OUT probe(void);
+  /// Number of packages that are part of the search
+  unsigned int numSearch(void) const;
+  /**
+   * \brief Writes the packages and relations to \a solved and \a search
+   * after processing. Returns the number of packages in the search part.
+   *
+   * Every package of a relation written to \a search is also declared in it:
+   * the solved packages with relations in the search part are written to both
+   * outputs as keep install.
+   */
+  unsigned int output(KCudfWriter& solved, KCudfWriter& search);
+  /**
+   * \brief Solves the search part with the built-in solver if it is small
+   * enough (see \a solverThreshold) and writes the outputs.
+   */
+  RD_OUT conclude(KCudfWriter& solved, KCudfWriter& search);
 private:
   /// Set of packages that need to be initializated in search state
   std::set<int> init_search;
@@ -205,15 +359,100 @@ public:
   /// Destructor
   virtual ~KCudfReducer(void);
   void package(unsigned int p, bool keep, bool install, const char*);
+  /**
+   * \brief Puts in search state the representatives of the classes of \a m
+   * with a paranoid member. It is called once the collapsed problem has been
+   * written to the reducer.
+   */
+  void collapsed(const KCudfMerging& m);
   /**
    * \brief Write the reduced problem using writers \a easy and \a
    * search. The return value is either \a RDO_SEARCH in case that a
    * search step is needed to solve the problem or \a RDO_SOL in the
    * case that the solution is found by the reducer.  statistics will
-   * be available through \a st.
+   * be available through \a st. \a RDO_CANCEL is returned when the
+   * cancellation token expires (see \a cancellation).
+   *
+   * A reducer reduces its problem once, whatever the outcome.
    */
   RD_OUT reduce(KCudfWriter& easy, KCudfWriter& search);
+  /**
+   * \brief Solves search parts of at most \a n packages with the built-in
+   * solver (see \a KCudfSolver); 0, the default, disables it.
+   *
+   * When the solver finds a solution, \a reduce writes it to the solved
+   * writer and returns \a RDO_SOL with nothing written to the search one. If
+   * the solver gives up, the search part is written as usual.
+   */
+  void solverThreshold(unsigned int n);
+  /**
+   * \brief Runs the probing stage with \a n threads after processing; 0, the
+   * default, disables it.
+   *
+   * Every package in search state is tentatively installed and uninstalled
+   * and the consequences propagated over the search part. When one of the
+   * probes fails the package gets the opposite state for good. Probes run in
+   * decreasing order of degree, every thread with its own overlay of states.
+   */
+  void probing(unsigned int n);
+  /**
+   * \brief Leaves out of the search part the dependencies between packages in
+   * search state that follow from a chain of other ones.
+   *
+   * The reduction is done on the graph of the strongly connected components:
+   * a dependency between two components is left out when there is a longer
+   * path between them, and only one dependency is kept between the same
+   * components. Dependencies inside a component are all kept. The
+   * reachability is computed with bitsets when the number of components
+   * allows it and with a bounded search otherwise, which can keep some
+   * redundant dependencies.
+   */
+  void transitiveReduction(bool on);
+  /**
+   * \brief Sets the scheduling policy \a p of the todo lists, \a WLP_FIFO by
+   * default.
+   *
+   * The policy only orders the can operations, which are run once no must
+   * operation is pending. \a WLP_DEGREE runs first the tasks on the packages
+   * with more relations and \a WLP_BUCKET the tasks in the order of the
+   * operations (see \a PK_OP). It must be set before reading the packages.
+   *
+   * The fixed point does not depend on the policy. The first list is always
+   * fifo: whether the update of the candidate providers adds a dependency
+   * depends on when it runs. Can operations only move packages up from CI
+   * and CU to SR and do not change the candidate providers, so the can
+   * phase is a monotone iteration that reaches the same states in any
+   * order. Only the number of tasks run, reported in the statistics,
+   * changes.
+   */
+  void scheduling(WL_POLICY p);
+  /**
+   * \brief Stops the reduction when \a ct expires; NULL, the default,
+   * disables it.
+   *
+   * The token is checked every 1024 tasks while processing, by every probe
+   * and before writing the output. When it expires \a reduce returns \a
+   * RDO_CANCEL with nothing written and the statistics collected so far.
+   * The reducer keeps the state of the interrupted reduction (pending tasks
+   * included) and cannot be reused: a new reducer has to read the problem
+   * again.
+   */
+  void cancellation(const CancelToken* ct);
   const ReducerStats& stats() const;
+  /**
+   * \brief Enables or disables the tracking of pending tasks to count
+   * duplicate tasks in the statistics.
+   *
+   * All the other counters are always collected. This one requires an extra
+   * map lookup per task and is disabled by default.
+   */
+  void profile(bool on);
+  /**
+   * \brief Adds the memory used by the reducer to report \a r.
+   *
+   * The todo lists are also reported at their high-water mark.
+   */
+  virtual void memory(MemoryReport& r) const;
   /// Return the state of a given package
   PKR_STATE state(unsigned int id) const;
   /// Return the number of safe providers for package \a p
@@ -0,0 +1,180 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__RENUMBER__HH__
+#define __KCUDF__RENUMBER__HH__
+
+#include <kcudf/kcudf.hh>
+
+/**
+ * \file Dense renumbering of package identifiers.
+ *
+ * The translator does not use all the identifiers it creates (forwarded and
+ * discarded disjunctions keep theirs) and the reducer only outputs a subset of
+ * its input. The writers in this file rename the identifiers they see to
+ * consecutive ones starting from 0, in order of appearance, so consumers can
+ * use arrays of the exact size instead of maps. The renumbering is kept in a
+ * \a KCudfRenumbering that can be written as a table to translate back.
+ */
+
+/**
+ * \brief Mapping between original and consecutive identifiers.
+ */
+class KCudfRenumbering {
+private:
+  /// New identifier for every original one (NONE if it was not seen)
+  std::vector<unsigned int> fwd;
+  /// Original identifier for every new one
+  std::vector<unsigned int> bwd;
+public:
+  /// Value for identifiers that are not in the mapping
+  static const unsigned int NONE = ~0u;
+  /// Returns the new identifier for \a id, creating it if needed
+  unsigned int map(unsigned int id) {
+    if (fwd.size() <= id)
+      fwd.resize(id + 1, NONE);
+    if (fwd[id] == NONE) {
+      fwd[id] = bwd.size();
+      bwd.push_back(id);
+    }
+    return fwd[id];
+  }
+  /// Returns the new identifier for \a id or NONE if it was not seen
+  unsigned int renumbered(unsigned int id) const {
+    return id < fwd.size() ? fwd[id] : NONE;
+  }
+  /// Returns the original identifier of new identifier \a id
+  unsigned int original(unsigned int id) const {
+    return id < bwd.size() ? bwd[id] : NONE;
+  }
+  /// Number of identifiers in the mapping
+  unsigned int size(void) const {
+    return bwd.size();
+  }
+  /**
+   * \brief Writes the mapping on \a os as lines "new original", in increasing
+   * order of new identifiers.
+   */
+  void write(std::ostream& os) const;
+  /**
+   * \brief Reads a mapping written by \a write from \a is.
+   *
+   * Throws \a KCudfReaderInvalidStatement if the table is not consecutive.
+   */
+  void read(std::istream& is);
+};
+
+/**
+ * \brief Writer that renames identifiers with \a rn before passing them to \a
+ * wrt.
+ *
+ * If \a restore is true the identifiers are translated back to the original
+ * ones instead (for instance to apply a solution of a renumbered problem with
+ * \a readPackages); identifiers outside the mapping become \a
+ * KCudfRenumbering::NONE.
+ */
+template <class Writer>
+class KCudfRenumberWriter final : public KCudfWriter {
+private:
+  /// Writer receiving the renamed relations
+  Writer& wrt;
+  /// Renumbering
+  KCudfRenumbering& rn;
+  /// Whether identifiers are translated back
+  bool restore;
+  /// Identifiers of the last group
+  std::vector<unsigned int> g;
+  /// Translates \a id
+  unsigned int id(unsigned int p) {
+    return restore ? rn.original(p) : rn.map(p);
+  }
+public:
+  /// Constructor
+  KCudfRenumberWriter(Writer& w, KCudfRenumbering& r, bool rs = false)
+    : wrt(w), rn(r), restore(rs) {}
+  void package(unsigned int p, bool keep, bool install, const char* desc) {
+    wrt.package(id(p), keep, install, desc);
+  }
+  void unprovided(unsigned int p) {
+    wrt.unprovided(id(p));
+  }
+  void dependency(unsigned int p, unsigned int q, const char* desc) {
+    unsigned int np = id(p);
+    wrt.dependency(np, id(q), desc);
+  }
+  void conflict(unsigned int p, unsigned int q, const char* desc) {
+    // keep the smaller identifier first
+    unsigned int np = id(p), nq = id(q);
+    wrt.conflict(std::min(np, nq), std::max(np, nq), desc);
+  }
+  void provides(unsigned int p, unsigned int q, const char* desc) {
+    unsigned int np = id(p);
+    wrt.provides(np, id(q), desc);
+  }
+  void atMostOne(const std::vector<unsigned int>& og, const char* desc) {
+    g.clear();
+    for (unsigned int p : og)
+      g.push_back(id(p));
+    std::sort(g.begin(), g.end());
+    wrt.atMostOne(g, desc);
+  }
+};
+
+/**
+ * \brief Info writer that renames identifiers with \a rn before passing them
+ * to \a inf.
+ *
+ * To get the same identifiers in the kcudf and in the info output, both
+ * writers must share the renumbering.
+ */
+template <class InfoWriter>
+class KCudfRenumberInfoWriter final : public KCudfInfoWriter {
+private:
+  /// Writer receiving the renamed packages
+  InfoWriter& inf;
+  /// Renumbering
+  KCudfRenumbering& rn;
+public:
+  /// Constructor
+  KCudfRenumberInfoWriter(InfoWriter& i, KCudfRenumbering& r)
+    : inf(i), rn(r) {}
+  void package(unsigned int id, unsigned int version, const char* name) {
+    inf.package(rn.map(id), version, name);
+  }
+  void artificial(unsigned int id, const char* desc) {
+    inf.artificial(rn.map(id), desc);
+  }
+};
+
+#endif
@@ -0,0 +1,222 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <kcudf/satwriter.hh>
+
+/*
+ * KCudfSatWriter
+ */
+KCudfSatWriter::KCudfSatWriter(const char* f, const char* vm)
+  : KCudfWriter(), fname(f), vname(vm), nclauses(0) {}
+
+KCudfSatWriter::KCudfSatWriter(void)
+  : KCudfWriter(), nclauses(0) {}
+
+KCudfSatWriter::~KCudfSatWriter(void) {}
+
+int KCudfSatWriter::var(unsigned int id) {
+  if (vars.size() <= id)
+    vars.resize(id + 1, 0);
+  if (vars[id] == 0) {
+    ids.push_back(id);
+    inst.push_back(false);
+    keeps.push_back(false);
+    declared.push_back(false);
+    vars[id] = ids.size();
+  }
+  return vars[id];
+}
+
+void KCudfSatWriter::clause(std::initializer_list<int> c) {
+  clauses.insert(clauses.end(), c.begin(), c.end());
+  clauses.push_back(0);
+  nclauses++;
+}
+
+void KCudfSatWriter::package(unsigned int p, bool keep, bool install, const char*) {
+  int v = var(p);
+  inst[v - 1] = install;
+  keeps[v - 1] = keep;
+  declared[v - 1] = true;
+  if (keep)
+    clause({install ? v : -v});
+}
+
+void KCudfSatWriter::dependency(unsigned int p, unsigned int q, const char*) {
+  // self dependencies are generated by the reader
+  if (p != q)
+    clause({-var(p), var(q)});
+}
+
+void KCudfSatWriter::conflict(unsigned int p, unsigned int q, const char*) {
+  clause({-var(p), -var(q)});
+}
+
+void KCudfSatWriter::provides(unsigned int p, unsigned int q, const char*) {
+  int vp = var(p);
+  pvdrs[var(q)].push_back(vp);
+}
+
+void KCudfSatWriter::atMostOne(const std::vector<unsigned int>& g, const char*) {
+  std::vector<int> vg;
+  vg.reserve(g.size());
+  for (unsigned int p : g)
+    vg.push_back(var(p));
+  groups.push_back(vg);
+}
+
+void KCudfSatWriter::finish(void) {
+  for (auto& p : pvdrs) {
+    clauses.push_back(-static_cast<int>(p.first));
+    clauses.insert(clauses.end(), p.second.begin(), p.second.end());
+    clauses.push_back(0);
+    nclauses++;
+  }
+  pvdrs.clear();
+}
+
+void KCudfSatWriter::writeVarMap(void) const {
+  OutputFile os(vname.c_str());
+  for (unsigned int v = 0; v < ids.size(); v++)
+    os << (v + 1) << " " << ids[v] << '\n';
+  os.close();
+}
+
+void KCudfSatWriter::writeClause(std::ostream& os, const int* c, bool opb) {
+  if (!opb) {
+    for (; *c != 0; c++)
+      os << *c << ' ';
+    os << "0\n";
+    return;
+  }
+  // sum(positive) - sum(negative) >= 1 - |negative|
+  int rhs = 1;
+  for (; *c != 0; c++) {
+    if (*c > 0) {
+      os << "+1 x" << *c << ' ';
+    } else {
+      os << "-1 x" << -*c << ' ';
+      rhs--;
+    }
+  }
+  os << ">= " << rhs << " ;\n";
+}
+
+unsigned int KCudfSatWriter::encodeGroups(unsigned int pairwise) {
+  // sequential counter (Sinz, 2005) for the large groups
+  unsigned int nv = ids.size();
+  for (const std::vector<int>& g : groups) {
+    if (g.size() <= pairwise) {
+      for (size_t i = 0; i < g.size(); i++)
+        for (size_t j = i + 1; j < g.size(); j++)
+          clause({-g[i], -g[j]});
+      continue;
+    }
+    // s_i is true if one of the first i variables is true
+    int s = nv + 1;
+    nv += g.size() - 1;
+    clause({-g[0], s});
+    for (size_t i = 1; i + 1 < g.size(); i++) {
+      clause({-g[i], s + static_cast<int>(i)});
+      clause({-(s + static_cast<int>(i) - 1), s + static_cast<int>(i)});
+      clause({-g[i], -(s + static_cast<int>(i) - 1)});
+    }
+    clause({-g.back(), -(s + static_cast<int>(g.size()) - 2)});
+  }
+  groups.clear();
+  return nv;
+}
+
+/*
+ * KCudfDimacsWriter
+ */
+KCudfDimacsWriter::KCudfDimacsWriter(const char* f, const char* vm)
+  : KCudfSatWriter(f, vm) {}
+
+KCudfDimacsWriter::~KCudfDimacsWriter(void) {
+  finish();
+  unsigned int nv = encodeGroups(PAIRWISE);
+
+  OutputFile os(fname.c_str());
+  os << "c kcudf search problem, variable map in " << vname << '\n'
+     << "p cnf " << nv << " " << nclauses << '\n';
+  for (size_t i = 0; i < clauses.size(); ) {
+    writeClause(os, &clauses[i], false);
+    while (clauses[i] != 0) i++;
+    i++;
+  }
+  os.close();
+  writeVarMap();
+}
+
+/*
+ * KCudfOpbWriter
+ */
+KCudfOpbWriter::KCudfOpbWriter(const char* f, const char* vm)
+  : KCudfSatWriter(f, vm) {}
+
+void KCudfOpbWriter::weight(unsigned int id, unsigned int w) {
+  weights[id] = w;
+}
+
+KCudfOpbWriter::~KCudfOpbWriter(void) {
+  finish();
+  OutputFile os(fname.c_str());
+  os << "* #variable= " << ids.size()
+     << " #constraint= " << (nclauses + groups.size()) << '\n'
+     << "* kcudf search problem, variable map in " << vname << '\n';
+  // weighted changes of the packages that are not kept (up to a constant)
+  if (std::find(keeps.begin(), keeps.end(), false) != keeps.end()) {
+    os << "min:";
+    for (unsigned int v = 0; v < ids.size(); v++) {
+      if (keeps[v]) continue;
+      auto w = weights.find(ids[v]);
+      os << (inst[v] ? " -" : " +") << (w == weights.end() ? 1 : w->second)
+         << " x" << (v + 1);
+    }
+    os << " ;\n";
+  }
+  for (size_t i = 0; i < clauses.size(); ) {
+    writeClause(os, &clauses[i], true);
+    while (clauses[i] != 0) i++;
+    i++;
+  }
+  for (const std::vector<int>& g : groups) {
+    for (int v : g)
+      os << "-1 x" << v << ' ';
+    os << ">= -1 ;\n";
+  }
+  os.close();
+  writeVarMap();
+}
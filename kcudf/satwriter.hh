@@ -0,0 +1,228 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__SATWRITER__HH__
+#define __KCUDF__SATWRITER__HH__
+
+#include <kcudf/kcudf.hh>
+#include <kcudf/zstream.hh>
+
+/**
+ * \file Writers of kcudf problems for SAT and pseudo-boolean solvers.
+ *
+ * Every package becomes a boolean variable (true means installed) and:
+ * - a package marked keep becomes a unit clause with its install state,
+ * - a dependency "p depends on q" becomes the clause -p q,
+ * - a conflict becomes the binary clause -p -q,
+ * - an at-most-one group becomes one constraint (OPB) or a sequential counter
+ *   (CNF, pairwise clauses for small groups),
+ * - a package provided by p1 ... pn becomes the clause -q p1 ... pn. Packages
+ *   that are not the target of any provides relation are not constrained in
+ *   this way.
+ *
+ * Every package of a relation must have been passed to \a package, otherwise
+ * its variable is free (\a KCudfReducer::output declares the solved packages
+ * that have relations in the search part).
+ *
+ * Besides the problem, a variable map file with lines "variable identifier"
+ * is written, \a readModel uses it to turn the model computed by a solver
+ * back into package calls on a \a KCudfWriter (for instance a \a CudfUpdater).
+ * The auxiliary variables of the CNF encoding are not in the map.
+ */
+
+/**
+ * \brief Base class for the writers of boolean problems.
+ *
+ * The problem is collected in memory (the headers of both formats need the
+ * number of variables and constraints) and written when the concrete writer
+ * is destroyed.
+ */
+class KCudfSatWriter : public KCudfWriter {
+protected:
+  /// Name of the output file
+  std::string fname;
+  /// Name of the variable map file
+  std::string vname;
+  /// Variable of every package identifier (0 if none)
+  std::vector<unsigned int> vars;
+  /// Package identifier of every variable (starting from variable 1)
+  std::vector<unsigned int> ids;
+  /// Install state of every variable (starting from variable 1)
+  std::vector<bool> inst;
+  /// Whether every variable is marked keep (starting from variable 1)
+  std::vector<bool> keeps;
+  /// Whether every variable was passed to \a package (starting from variable 1)
+  std::vector<bool> declared;
+  /// Clauses as signed variables, each one ended by 0
+  std::vector<int> clauses;
+  /// Number of clauses in \a clauses
+  unsigned int nclauses;
+  /// Providers of every provided variable
+  std::map<unsigned int, std::vector<int> > pvdrs;
+  /// At-most-one groups (as variables)
+  std::vector<std::vector<int> > groups;
+  /// Returns the variable of package \a id, creating it if needed
+  int var(unsigned int id);
+  /// Adds the clause \a c
+  void clause(std::initializer_list<int> c);
+  /// Adds the clauses for provided packages, called once before writing
+  void finish(void);
+  /// Writes the variable map
+  void writeVarMap(void) const;
+  /// Writes clause \a c (ended by 0) on \a os in DIMACS or OPB notation
+  static void writeClause(std::ostream& os, const int* c, bool opb);
+  /**
+   * \brief Adds the clauses of the at-most-one groups: pairwise clauses for
+   * groups up to \a pairwise members and a sequential counter for larger ones.
+   *
+   * Returns the number of variables including the auxiliary ones.
+   */
+  unsigned int encodeGroups(unsigned int pairwise);
+  /// Constructor for writers that do not write files
+  KCudfSatWriter(void);
+public:
+  /**
+   * \brief Constructor for writing the problem to \a fname and the variable
+   * map to \a varmap.
+   */
+  KCudfSatWriter(const char* fname, const char* varmap);
+  /// Destructor
+  virtual ~KCudfSatWriter(void);
+  /// Register package \a p
+  void package(unsigned int p, bool keep, bool install, const char*) final;
+  /// Register the dependency between \a p and \a q
+  void dependency(unsigned int p, unsigned int q, const char*) final;
+  /// Register the conflict between \a p and \a q
+  void conflict(unsigned int p, unsigned int q, const char*) final;
+  /// Register the provides between \a p and \a q
+  void provides(unsigned int p, unsigned int q, const char*) final;
+  /// Register the at-most-one group \a g
+  void atMostOne(const std::vector<unsigned int>& g, const char*) final;
+};
+
+/**
+ * \brief Writes the problem in DIMACS CNF.
+ */
+class KCudfDimacsWriter final : public KCudfSatWriter {
+public:
+  /// Groups up to this size are encoded with pairwise clauses
+  static const unsigned int PAIRWISE = 6;
+  /// Constructor (see \a KCudfSatWriter)
+  KCudfDimacsWriter(const char* fname, const char* varmap);
+  /// Destructor, writes the files
+  virtual ~KCudfDimacsWriter(void);
+};
+
+/**
+ * \brief Writes the problem in the OPB format of the pseudo-boolean
+ * competitions.
+ *
+ * The objective minimizes the number of packages that change their install
+ * state. A package can weigh more than one, when it stands for a class of
+ * merged packages that change with it (see \a KCudfMerging).
+ */
+class KCudfOpbWriter final : public KCudfSatWriter {
+private:
+  /// Weight in the objective of the package identifiers that do not weigh 1
+  std::map<unsigned int, unsigned int> weights;
+public:
+  /// Constructor (see \a KCudfSatWriter)
+  KCudfOpbWriter(const char* fname, const char* varmap);
+  /// Destructor, writes the files
+  virtual ~KCudfOpbWriter(void);
+  /// Sets the weight of package \a id in the objective to \a w
+  void weight(unsigned int id, unsigned int w);
+};
+
+/// Identifier for variables that are not in a variable map
+const unsigned int KCUDF_NO_VAR = ~0u;
+
+/**
+ * \brief Reads the model computed by a SAT or pseudo-boolean solver in \a model
+ * and reports every mapped variable to \a wrt as a package marked keep and
+ * installed if the variable is true.
+ *
+ * \a varmap is the variable map written with the problem. The model lines are
+ * "v" lines of the competition formats (literals as "3", "-3", "x3" or "-x3")
+ * or plain lists of literals. Throws \a KCudfFailedRequest if the solver
+ * reports that there is no solution and \a KCudfFailure if it reports that
+ * it does not know (s UNKNOWN or s UNSUPPORTED).
+ */
+template <class Writer>
+void readModel(std::istream& model, std::istream& varmap, Writer& wrt) {
+  KCUDF_TRACE_SCOPE("readModel");
+  if (model.fail() || varmap.fail())
+    throw FailedStream("unable to open stream for reading");
+
+  std::vector<unsigned int> ids;
+  unsigned int v, id;
+  while (varmap >> v >> id) {
+    if (ids.size() <= v)
+      ids.resize(v + 1, KCUDF_NO_VAR);
+    ids[v] = id;
+  }
+
+  std::string line;
+  while (std::getline(model, line)) {
+    if (line.empty()) continue;
+    const char *s = line.c_str();
+    if (line[0] == 's' || line.compare(0, 3, "SAT") == 0 ||
+        line.compare(0, 5, "UNSAT") == 0) {
+      if (line.find("UNSAT") != std::string::npos)
+        throw KCudfFailedRequest("the solver found no solution");
+      if (line.find("UNKNOWN") != std::string::npos ||
+          line.find("UNSUPPORTED") != std::string::npos)
+        throw KCudfFailure("the solver found neither a solution nor a proof "
+                           "that there is none");
+      continue;
+    }
+    if (line[0] == 'v')
+      s++;
+    else if (line[0] != '-' && line[0] != 'x' &&
+             !std::isdigit(static_cast<unsigned char>(line[0])))
+      // comments, objective values and other solver output
+      continue;
+    while (true) {
+      while (*s == ' ' || *s == '\t') s++;
+      bool neg = (*s == '-' || *s == '~');
+      if (neg) s++;
+      if (*s == 'x') s++;
+      if (!readId(s, v) || v == 0) break;
+      if (v < ids.size() && ids[v] != KCUDF_NO_VAR)
+        wrt.package(ids[v], true, !neg, "");
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,237 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <kcudf/solver.hh>
+
+KCudfSolver::KCudfSolver(unsigned int conflicts)
+  : KCudfSatWriter(), maxConflicts(conflicts), nconflicts(0), ndecisions(0),
+    inc(1.0), qhead(0) {}
+
+KCudfSolver::~KCudfSolver(void) {}
+
+void KCudfSolver::enqueue(int l, int r) {
+  int v = std::abs(l);
+  val[v] = l > 0;
+  level[v] = decisionLevel();
+  reason[v] = r;
+  trail.push_back(l);
+}
+
+bool KCudfSolver::addClause(std::vector<int>& c) {
+  // remove duplicates and satisfied (tautological) clauses
+  std::sort(c.begin(), c.end());
+  c.erase(std::unique(c.begin(), c.end()), c.end());
+  for (size_t i = 0; i < c.size(); i++)
+    if (std::binary_search(c.begin(), c.end(), -c[i])) return true;
+  if (c.empty())
+    return false;
+  if (c.size() == 1) {
+    if (value(c[0]) == 0) return false;
+    if (value(c[0]) < 0) enqueue(c[0], -1);
+    return true;
+  }
+  watches[lit(c[0])].push_back(cls.size());
+  watches[lit(c[1])].push_back(cls.size());
+  cls.push_back(c);
+  return true;
+}
+
+int KCudfSolver::propagate(void) {
+  while (qhead < trail.size()) {
+    // literal that became false
+    int fl = -trail[qhead++];
+    std::vector<unsigned int>& ws = watches[lit(fl)];
+    size_t i = 0, j = 0;
+    while (i < ws.size()) {
+      unsigned int ci = ws[i++];
+      std::vector<int>& c = cls[ci];
+      if (c[0] == fl)
+        std::swap(c[0], c[1]);
+      if (value(c[0]) == 1) {
+        ws[j++] = ci;
+        continue;
+      }
+      // look for a new literal to watch
+      bool found = false;
+      for (size_t k = 2; k < c.size(); k++)
+        if (value(c[k]) != 0) {
+          std::swap(c[1], c[k]);
+          watches[lit(c[1])].push_back(ci);
+          found = true;
+          break;
+        }
+      if (found) continue;
+      ws[j++] = ci;
+      if (value(c[0]) == 0) {
+        // conflict
+        while (i < ws.size())
+          ws[j++] = ws[i++];
+        ws.resize(j);
+        qhead = trail.size();
+        return ci;
+      }
+      enqueue(c[0], ci);
+    }
+    ws.resize(j);
+  }
+  return -1;
+}
+
+void KCudfSolver::bump(int v) {
+  if ((activity[v] += inc) > 1e100) {
+    for (double& a : activity)
+      a *= 1e-100;
+    inc *= 1e-100;
+  }
+}
+
+void KCudfSolver::analyze(int confl, std::vector<int>& learnt) {
+  std::vector<bool> seen(val.size(), false);
+  learnt.assign(1, 0);
+  int pathC = 0;
+  int p = 0;
+  size_t idx = trail.size();
+  do {
+    const std::vector<int>& c = cls[confl];
+    // the implied literal of a reason is its first one
+    for (size_t j = (p == 0 ? 0 : 1); j < c.size(); j++) {
+      int v = std::abs(c[j]);
+      if (!seen[v] && level[v] > 0) {
+        seen[v] = true;
+        bump(v);
+        if (level[v] >= decisionLevel())
+          pathC++;
+        else
+          learnt.push_back(c[j]);
+      }
+    }
+    while (!seen[std::abs(trail[--idx])]) ;
+    p = trail[idx];
+    confl = reason[std::abs(p)];
+    seen[std::abs(p)] = false;
+    pathC--;
+  } while (pathC > 0);
+  learnt[0] = -p;
+  // the literal with the highest level is watched with the asserting one
+  size_t m = 1;
+  for (size_t i = 2; i < learnt.size(); i++)
+    if (level[std::abs(learnt[i])] > level[std::abs(learnt[m])])
+      m = i;
+  if (learnt.size() > 1)
+    std::swap(learnt[1], learnt[m]);
+  inc *= 1.05;
+}
+
+void KCudfSolver::cancelUntil(unsigned int l) {
+  if (decisionLevel() <= l) return;
+  for (size_t i = trail.size(); i > trailLim[l]; i--) {
+    int v = std::abs(trail[i - 1]);
+    phase[v] = val[v];
+    val[v] = -1;
+  }
+  trail.resize(trailLim[l]);
+  trailLim.resize(l);
+  qhead = trail.size();
+}
+
+int KCudfSolver::pickBranch(void) const {
+  int best = 0;
+  for (unsigned int v = 1; v < val.size(); v++)
+    if (val[v] < 0 && (best == 0 || activity[v] > activity[best]))
+      best = v;
+  if (best == 0) return 0;
+  return phase[best] ? best : -best;
+}
+
+KCudfSolver::SOLVE_OUT KCudfSolver::solve(void) {
+  KCUDF_TRACE_SCOPE("solve");
+  finish();
+  unsigned int nv = encodeGroups(KCudfDimacsWriter::PAIRWISE);
+  val.assign(nv + 1, -1);
+  level.assign(nv + 1, 0);
+  reason.assign(nv + 1, -1);
+  activity.assign(nv + 1, 0.0);
+  phase.assign(nv + 1, false);
+  for (unsigned int v = 1; v <= ids.size(); v++)
+    phase[v] = inst[v - 1];
+  watches.resize(2 * (nv + 1));
+
+  std::vector<int> c;
+  for (size_t i = 0; i < clauses.size(); i++) {
+    if (clauses[i] != 0) {
+      c.push_back(clauses[i]);
+      continue;
+    }
+    if (!addClause(c))
+      return SO_UNSAT;
+    c.clear();
+  }
+  clauses.clear();
+
+  std::vector<int> learnt;
+  while (true) {
+    int confl = propagate();
+    if (confl >= 0) {
+      nconflicts++;
+      if (decisionLevel() == 0)
+        return SO_UNSAT;
+      if (nconflicts > maxConflicts)
+        return SO_UNKNOWN;
+      analyze(confl, learnt);
+      unsigned int bt = learnt.size() > 1 ? level[std::abs(learnt[1])] : 0;
+      cancelUntil(bt);
+      if (learnt.size() == 1) {
+        enqueue(learnt[0], -1);
+      } else {
+        watches[lit(learnt[0])].push_back(cls.size());
+        watches[lit(learnt[1])].push_back(cls.size());
+        cls.push_back(learnt);
+        enqueue(learnt[0], cls.size() - 1);
+      }
+    } else {
+      int l = pickBranch();
+      if (l == 0)
+        return SO_SAT;
+      ndecisions++;
+      trailLim.push_back(trail.size());
+      enqueue(l, -1);
+    }
+  }
+}
+
+void KCudfSolver::solution(KCudfWriter& wrt, const char* desc) const {
+  for (unsigned int v = 1; v <= ids.size(); v++)
+    if (declared[v - 1] && !keeps[v - 1])
+      wrt.package(ids[v - 1], true, val[v] == 1, desc);
+}
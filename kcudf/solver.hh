@@ -0,0 +1,148 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__SOLVER__HH__
+#define __KCUDF__SOLVER__HH__
+
+#include <kcudf/satwriter.hh>
+
+/**
+ * \brief Small conflict driven solver for kcudf problems.
+ *
+ * The solver is a writer: the problem is passed to it as to any other writer
+ * and encoded as in \a KCudfSatWriter. It implements unit propagation with
+ * two watched literals, conflict analysis (first UIP) with clause learning and
+ * non-chronological backtracking, and an activity based decision heuristic.
+ * There are no restarts nor clause deletion: it is meant for the small
+ * problems left by the reducer, bigger ones are better handled by an external
+ * solver.
+ *
+ * Decisions follow the current install state of the packages, so solutions
+ * tend to change few packages, but they are not optimized.
+ */
+class KCudfSolver final : public KCudfSatWriter {
+public:
+  /// Result of the solver
+  enum SOLVE_OUT {
+    SO_SAT,     ///> A solution was found
+    SO_UNSAT,   ///> The problem has no solution
+    SO_UNKNOWN, ///> The conflict limit was reached
+  };
+private:
+  /// Maximum number of conflicts
+  unsigned int maxConflicts;
+  /// Number of conflicts
+  unsigned int nconflicts;
+  /// Number of decisions
+  unsigned int ndecisions;
+  /// Clauses with at least two literals (original and learnt)
+  std::vector<std::vector<int> > cls;
+  /// Clauses watching every literal (see \a lit)
+  std::vector<std::vector<unsigned int> > watches;
+  /// Value of every variable: -1 unassigned, 0 false, 1 true
+  std::vector<signed char> val;
+  /// Decision level of every variable
+  std::vector<unsigned int> level;
+  /// Clause that implied every variable (-1 for decisions and units)
+  std::vector<int> reason;
+  /// Activity of every variable
+  std::vector<double> activity;
+  /// Activity increment
+  double inc;
+  /// Preferred value of every variable
+  std::vector<bool> phase;
+  /// Assigned literals in order
+  std::vector<int> trail;
+  /// Start of every decision level in \a trail
+  std::vector<unsigned int> trailLim;
+  /// Next literal of the trail to propagate
+  unsigned int qhead;
+  /// Index of literal \a l in \a watches
+  static unsigned int lit(int l) {
+    return 2 * std::abs(l) + (l < 0);
+  }
+  /// Value of literal \a l: -1 unassigned, 0 false, 1 true
+  int value(int l) const {
+    int v = val[std::abs(l)];
+    return v < 0 ? v : (v == (l > 0));
+  }
+  /// Current decision level
+  unsigned int decisionLevel(void) const {
+    return trailLim.size();
+  }
+  /// Makes literal \a l true because of clause \a r
+  void enqueue(int l, int r);
+  /// Adds clause \a c, returns false if it makes the problem unsatisfiable
+  bool addClause(std::vector<int>& c);
+  /// Unit propagation, returns the conflicting clause or -1
+  int propagate(void);
+  /// Computes in \a learnt the clause learnt from conflict \a confl
+  void analyze(int confl, std::vector<int>& learnt);
+  /// Undoes the assignments above level \a l
+  void cancelUntil(unsigned int l);
+  /// Increases the activity of variable \a v
+  void bump(int v);
+  /// Returns the next decision literal or 0 if all variables are assigned
+  int pickBranch(void) const;
+public:
+  /// Constructor for a solver giving up after \a conflicts conflicts
+  KCudfSolver(unsigned int conflicts = 10000);
+  /// Destructor
+  virtual ~KCudfSolver(void);
+  /// Number of packages in the problem
+  unsigned int numPackages(void) const {
+    return ids.size();
+  }
+  /// Solves the problem, it can only be called once
+  SOLVE_OUT solve(void);
+  /**
+   * \brief Writes the solution to \a wrt: every package is marked keep and
+   * installed or not, with description \a desc.
+   *
+   * Only the packages passed to \a package and not marked keep are written:
+   * the state of the kept ones is the one they were given, and packages that
+   * only appear in relations are not part of the problem.
+   */
+  void solution(KCudfWriter& wrt, const char* desc) const;
+  /// Number of conflicts
+  unsigned int conflicts(void) const {
+    return nconflicts;
+  }
+  /// Number of decisions
+  unsigned int decisions(void) const {
+    return ndecisions;
+  }
+};
+
+#endif
@@ -44,10 +44,14 @@ using namespace std;
  */
 
 KCudfFileWriter::KCudfFileWriter(const char* fname)
-  : KCudfWriter(), os(fname) {}
+  : KCudfWriter(), file(new OutputFile(fname)), os(*file) {}
+
+KCudfFileWriter::KCudfFileWriter(std::ostream& o)
+  : KCudfWriter(), os(o) {}
 
 KCudfFileWriter::~KCudfFileWriter(void) {
-  os.close();
+  if (file)
+    file->close();
 }
 
 void KCudfFileWriter::package(unsigned int id, bool keep, bool install, const char* desc) {
@@ -56,7 +60,7 @@ void KCudfFileWriter::package(unsigned int id, bool keep, bool install, const ch
 #endif
   os << "P " << id << " "
       << (keep ? "K" : "k") << " "
-      << (install ? "I" : "i") << " # " << desc << std::endl;
+      << (install ? "I" : "i") << " # " << desc << '\n';
 }
 
 void KCudfFileWriter::dependency(unsigned int id, unsigned int id2, const char* desc) {
@@ -65,7 +69,7 @@ void KCudfFileWriter::dependency(unsigned int id, unsigned int id2, const char*
   assert(cons.count(id2) > 0);
 #endif
   if (id != id2)
-    os << "D " << id << " " << id2 << " # " << desc << std::endl;
+    os << "D " << id << " " << id2 << " # " << desc << '\n';
 }
 
 void KCudfFileWriter::conflict(unsigned int id, unsigned int id2, const char* desc) {
@@ -73,7 +77,7 @@ void KCudfFileWriter::conflict(unsigned int id, unsigned int id2, const char* de
   assert(cons.count(id) > 0);
   assert(cons.count(id2) > 0);
 #endif
-  os << "C " << id << " " << id2 << " # " << desc << std::endl;
+  os << "C " << id << " " << id2 << " # " << desc << '\n';
 }
 
 void KCudfFileWriter::provides(unsigned int id, unsigned int id2, const char* desc) {
@@ -81,23 +85,87 @@ void KCudfFileWriter::provides(unsigned int id, unsigned int id2, const char* de
   assert(cons.count(id) > 0);
   assert(cons.count(id2) > 0);
 #endif
-  os << "R " << id << " " << id2 << " # " << desc << std::endl;
+  os << "R " << id << " " << id2 << " # " << desc << '\n';
+}
+
+void KCudfFileWriter::atMostOne(const std::vector<unsigned int>& g, const char* desc) {
+  os << "A";
+  for (unsigned int id : g) {
+#ifndef NDEBUG
+    assert(cons.count(id) > 0);
+#endif
+    os << " " << id;
+  }
+  os << " # " << desc << '\n';
 }
 
 /*
  * KCudfInfoFileWriter
  */
 KCudfInfoFileWriter::KCudfInfoFileWriter(const char* fname)
-  : KCudfInfoWriter(), os(fname) {}
+  : KCudfInfoWriter(), file(new OutputFile(fname)), os(*file) {}
 
+KCudfInfoFileWriter::KCudfInfoFileWriter(std::ostream& o)
+  : KCudfInfoWriter(), os(o) {}
 
 KCudfInfoFileWriter::~KCudfInfoFileWriter(void) {
-  os.close();
+  if (file)
+    file->close();
 }
 
 void
 KCudfInfoFileWriter::package(unsigned int id, unsigned int version, const char* name) {
-  os << id << " " << version << " " << name << std::endl;
+  os << id << " " << version << " " << name << '\n';
+}
+
+/*
+ * KCudfSolvedWriter
+ */
+
+KCudfSolvedWriter::KCudfSolvedWriter(const char* f)
+  : KCudfWriter(), fname(f), closed(false) {}
+
+void KCudfSolvedWriter::package(unsigned int id, bool, bool install, const char*) {
+  if (st.size() <= id)
+    st.resize(id + 1, 0);
+  st[id] = install ? 2 : 1;
+}
+
+void KCudfSolvedWriter::unprovided(unsigned int id) {
+  sp0.push_back(id);
+}
+
+KCudfSolvedWriter::~KCudfSolvedWriter(void) {
+  try {
+    close();
+  } catch (FailedStream&) {}
+}
+
+void KCudfSolvedWriter::close(void) {
+  if (closed)
+    return;
+  closed = true;
+  static const char run[] = {'S', 'U', 'I'};
+  // number of runs per line
+  const unsigned int width = 32;
+  OutputFile os(fname.c_str());
+  os << KCUDF_SOLVED_HEADER << '\n';
+  unsigned int nr = 0;
+  for (size_t i = 0; i < st.size(); ) {
+    size_t j = i + 1;
+    while (j < st.size() && st[j] == st[i]) j++;
+    os << (nr % width == 0 ? (nr == 0 ? "R" : "\nR") : "")
+       << ' ' << run[st[i]] << (j - i);
+    nr++;
+    i = j;
+  }
+  if (nr > 0) os << '\n';
+  for (size_t i = 0; i < sp0.size(); i++)
+    os << (i % width == 0 ? (i == 0 ? "Z" : "\nZ") : "") << ' ' << sp0[i];
+  if (!sp0.empty()) os << '\n';
+  os.close();
+  if (!os)
+    throw FailedStream("unable to write the compact solved file");
 }
 
 /*
@@ -127,6 +195,50 @@ void KCudfMemWriter::provides(unsigned int id, unsigned int id2, const char*) {
   pvds[id].insert(id2);
 }
 
+/*
+ * KCudfBufferWriter
+ */
+
+KCudfBufferWriter::KCudfBufferWriter(KCudfWriter& w)
+  : KCudfWriter(), wrt(w) {}
+
+KCudfBufferWriter::~KCudfBufferWriter(void) {}
+
+void KCudfBufferWriter::package(unsigned int p, bool keep, bool install, const char*) {
+  pkgs.push_back(std::make_tuple(p, keep, install));
+}
+
+void KCudfBufferWriter::dependency(unsigned int p, unsigned int q, const char*) {
+  deps.push_back(std::make_pair(p, q));
+}
+
+void KCudfBufferWriter::conflict(unsigned int p, unsigned int q, const char*) {
+  confs.push_back(std::make_pair(p, q));
+}
+
+void KCudfBufferWriter::provides(unsigned int p, unsigned int q, const char*) {
+  pvds.push_back(std::make_pair(p, q));
+}
+
+void KCudfBufferWriter::atMostOne(const std::vector<unsigned int>& g, const char*) {
+  groups.push_back(g);
+}
+
+std::map<unsigned int, unsigned int> KCudfBufferWriter::index(void) const {
+  std::map<unsigned int, unsigned int> idx;
+  for (unsigned int i = 0; i < pkgs.size(); i++)
+    idx[std::get<0>(pkgs[i])] = i;
+  return idx;
+}
+
+void KCudfBufferWriter::clear(void) {
+  pkgs.clear();
+  deps.clear();
+  confs.clear();
+  pvds.clear();
+  groups.clear();
+}
+
 /*
  * KCudfInfoMemWriter
  */
@@ -38,6 +38,7 @@
 #define __KCUDF__SWRITER__HH__
 
 #include <kcudf/kcudf.hh>
+#include <kcudf/zstream.hh>
 
 /**
  * \file This file contains the implementations of standard kcudf writers.
@@ -50,13 +51,19 @@
 /**
  * \brief Dumps KCUDF information to a file.
  *
+ * The file is compressed if its name ends in ".gz" or ".zst" (see \a
+ * OutputFile).
+ *
  * \warning If compiled in debug mode, a sanity check for every realtion is done.
  * it is quite trivial but useful: after reading a dependency, conflict or provide
  * relation, both identifiers are checked as already existent packages.
  */
-class KCudfFileWriter : public KCudfWriter {
+class KCudfFileWriter final : public KCudfWriter {
 private:
-  std::ofstream os;
+  /// File opened by the writer (NULL when writing to a stream)
+  std::unique_ptr<OutputFile> file;
+  /// Output stream
+  std::ostream& os;
 #ifndef NDEBUG
   // consistency check data structure
   std::set<unsigned int> cons;
@@ -67,6 +74,8 @@ protected:
 public:
   /// Constructor for using \a fname as output
   KCudfFileWriter(const char* fname);
+  /// Constructor for using stream \a o as output, it is not closed
+  KCudfFileWriter(std::ostream& o);
   /// Destructor
   virtual ~KCudfFileWriter(void);
   /**
@@ -83,19 +92,84 @@ public:
   virtual void conflict(unsigned int id, unsigned int id2, const char* desc);
   /// Writes disjunction information to the output file
   virtual void provides(unsigned int id, unsigned int id2, const char* desc);
+  /// Writes at-most-one group information to the output file
+  virtual void atMostOne(const std::vector<unsigned int>& g, const char* desc);
 };
 
 /**
- * \brief Info wrtier to write KCudf informaion to a file
+ * \brief Writes the packages of a solved kcudf in a compact form.
+ *
+ * Every package written to a solved output carries a single bit (installed
+ * or not), so instead of one line per package the file contains run lengths
+ * over the identifier range:
+ *
+ * \verbatim
+ #KCUDF-SOLVED 1
+ R I3 U12 S2 I1 ...
+ Z 12 40 ...
+ \endverbatim
+ *
+ * where I, U and S are runs of installed, uninstalled and absent identifiers
+ * starting from 0, and Z lists the packages that have no safe provider yet
+ * (see \a KCudfWriter::unprovided). The file is read back with \a readSolved
+ * or \a readPackages.
+ *
+ * \warning Only packages are stored: all of them are read back as keep and
+ * relations are ignored. The output is written by \a close.
  */
-class KCudfInfoFileWriter : public KCudfInfoWriter {
+class KCudfSolvedWriter final : public KCudfWriter {
 private:
-  std::ofstream os;
+  /// Name of the output file
+  std::string fname;
+  /// State of every identifier: 0 absent, 1 uninstalled, 2 installed
+  std::vector<unsigned char> st;
+  /// Packages without safe provider
+  std::vector<unsigned int> sp0;
+  /// Whether the file was already written
+  bool closed;
+  /// Default constructor
+  KCudfSolvedWriter(void);
+public:
+  /// Constructor for using \a fname as output
+  KCudfSolvedWriter(const char* fname);
+  /// Destructor, writes the file if \a close was not called (ignoring errors)
+  virtual ~KCudfSolvedWriter(void);
+  /**
+   * \brief Writes the file, throws \a FailedStream if it cannot be written
+   * completely. Later calls do nothing.
+   */
+  void close(void);
+  /// Registers package \a id
+  virtual void package(unsigned int id, bool keep, bool install, const char* desc);
+  /// Registers package \a id as without safe provider
+  virtual void unprovided(unsigned int id);
+  /// Ignored
+  virtual void dependency(unsigned int, unsigned int, const char*) {}
+  /// Ignored
+  virtual void conflict(unsigned int, unsigned int, const char*) {}
+  /// Ignored
+  virtual void provides(unsigned int, unsigned int, const char*) {}
+  /// Ignored
+  virtual void atMostOne(const std::vector<unsigned int>&, const char*) {}
+};
+
+/**
+ * \brief Info wrtier to write KCudf informaion to a file, compressed as
+ * \a KCudfFileWriter does.
+ */
+class KCudfInfoFileWriter final : public KCudfInfoWriter {
+private:
+  /// File opened by the writer (NULL when writing to a stream)
+  std::unique_ptr<OutputFile> file;
+  /// Output stream
+  std::ostream& os;
   /// Default constructor
   KCudfInfoFileWriter(void);
 public:
   /// Constructor for using stream  \a o for output
   KCudfInfoFileWriter(const char* fname);
+  /// Constructor for using stream \a o as output, it is not closed
+  KCudfInfoFileWriter(std::ostream& o);
   /// Destructor
   virtual ~KCudfInfoFileWriter(void);
   /// Write information about package \a id
@@ -137,6 +211,61 @@ public:
   virtual void provides(unsigned int id, unsigned int id2, const char*);
 };
 
+/**
+ * \brief Base of the writers that buffer the problem they receive and write
+ * a transformed one to \a wrt when they are flushed.
+ */
+class KCudfBufferWriter : public KCudfWriter {
+protected:
+  /// Relation between two packages
+  typedef std::pair<unsigned int, unsigned int> relation_t;
+  /// Writer receiving the transformed problem
+  KCudfWriter& wrt;
+  /// Packages with their keep and install flags
+  std::vector<std::tuple<unsigned int, bool, bool> > pkgs;
+  /// Dependencies
+  std::vector<relation_t> deps;
+  /// Conflicts
+  std::vector<relation_t> confs;
+  /// Provides
+  std::vector<relation_t> pvds;
+  /// At-most-one groups
+  std::vector<std::vector<unsigned int> > groups;
+  /// Index in \a pkgs of every package
+  std::map<unsigned int, unsigned int> index(void) const;
+  /**
+   * \brief Replaces every package of the relations \a rs by \a id of it and
+   * removes the duplicates. Relations of a package with itself are removed
+   * unless \a self, the ones of symmetric relations (\a sym) are stored with
+   * the smaller package first.
+   */
+  template <class Id>
+  static void rewrite(std::vector<relation_t>& rs, Id id, bool sym, bool self) {
+    std::set<relation_t> done;
+    std::vector<relation_t> out;
+    for (auto& r : rs) {
+      relation_t nr(id(r.first), id(r.second));
+      if (sym && nr.first > nr.second)
+        std::swap(nr.first, nr.second);
+      if ((self || nr.first != nr.second) && done.insert(nr).second)
+        out.push_back(nr);
+    }
+    rs.swap(out);
+  }
+  /// Releases the buffered problem
+  void clear(void);
+public:
+  /// Constructor for a writer passing the transformed problem to \a w
+  KCudfBufferWriter(KCudfWriter& w);
+  /// Destructor
+  virtual ~KCudfBufferWriter(void);
+  virtual void package(unsigned int p, bool keep, bool install, const char*);
+  virtual void dependency(unsigned int p, unsigned int q, const char*);
+  virtual void conflict(unsigned int p, unsigned int q, const char*);
+  virtual void provides(unsigned int p, unsigned int q, const char*);
+  virtual void atMostOne(const std::vector<unsigned int>& g, const char*);
+};
+
 /**
  * \brief Info wrtier to write KCudf informaion to a map in memory
  */
@@ -0,0 +1,219 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <kcudf/symmetry.hh>
+
+/*
+ * KCudfSymmetryWriter
+ */
+KCudfSymmetryWriter::KCudfSymmetryWriter(KCudfWriter& w)
+  : KCudfBufferWriter(w), ncls(0) {}
+
+KCudfSymmetryWriter::~KCudfSymmetryWriter(void) {}
+
+void KCudfSymmetryWriter::package(unsigned int p, bool keep, bool install,
+                                  const char* desc) {
+  KCudfBufferWriter::package(p, keep, install, desc);
+  wrt.package(p, keep, install, desc);
+}
+
+void KCudfSymmetryWriter::dependency(unsigned int p, unsigned int q, const char* desc) {
+  KCudfBufferWriter::dependency(p, q, desc);
+  wrt.dependency(p, q, desc);
+}
+
+void KCudfSymmetryWriter::conflict(unsigned int p, unsigned int q, const char* desc) {
+  KCudfBufferWriter::conflict(p, q, desc);
+  wrt.conflict(p, q, desc);
+}
+
+void KCudfSymmetryWriter::provides(unsigned int p, unsigned int q, const char* desc) {
+  KCudfBufferWriter::provides(p, q, desc);
+  wrt.provides(p, q, desc);
+}
+
+void KCudfSymmetryWriter::atMostOne(const std::vector<unsigned int>& g,
+                                    const char* desc) {
+  KCudfBufferWriter::atMostOne(g, desc);
+  wrt.atMostOne(g, desc);
+}
+
+namespace {
+  /// Kinds of relations of a package
+  enum SYM_REL {
+    SYM_DEP,    ///> Dependencies
+    SYM_DEPR,   ///> Dependers
+    SYM_CONF,   ///> Conflicts
+    SYM_PVD,    ///> Provides
+    SYM_PVDR,   ///> Providers
+    SYM_GROUP,  ///> At-most-one groups (their indices)
+    SYM_NRELS
+  };
+  /// Largest number of refinement rounds
+  const unsigned int SYM_MAX_ROUNDS = 32;
+  /// Largest number of classes a package is checked against in its color
+  const unsigned int SYM_MAX_CLASSES = 16;
+}
+
+unsigned int KCudfSymmetryWriter::flush(void) {
+  KCUDF_TRACE_SCOPE("symmetry");
+  const unsigned int NONE = ~0u;
+  const unsigned int n = pkgs.size();
+  // packages are indexed from 0 to n - 1, unknown identifiers after them
+  std::map<unsigned int, unsigned int> idx = index();
+  auto indexOf = [&](unsigned int p) -> unsigned int {
+    return idx.insert(std::make_pair(p, idx.size())).first->second;
+  };
+  std::vector<std::vector<unsigned int> > nb(SYM_NRELS * n);
+  auto add = [&](unsigned int p, unsigned int k, unsigned int q) {
+    unsigned int i = indexOf(p);
+    if (i < n) nb[SYM_NRELS * i + k].push_back(q);
+  };
+  for (auto& r : deps) {
+    add(r.first, SYM_DEP, indexOf(r.second));
+    add(r.second, SYM_DEPR, indexOf(r.first));
+  }
+  for (auto& r : confs) {
+    add(r.first, SYM_CONF, indexOf(r.second));
+    add(r.second, SYM_CONF, indexOf(r.first));
+  }
+  for (auto& r : pvds) {
+    add(r.first, SYM_PVD, indexOf(r.second));
+    add(r.second, SYM_PVDR, indexOf(r.first));
+  }
+  for (unsigned int g = 0; g < groups.size(); g++)
+    for (unsigned int p : groups[g])
+      add(p, SYM_GROUP, g);
+  for (std::vector<unsigned int>& v : nb) {
+    std::sort(v.begin(), v.end());
+    v.erase(std::unique(v.begin(), v.end()), v.end());
+  }
+
+  // colors: flags and degrees, refined with the colors of the neighbours
+  std::vector<unsigned int> color(n);
+  unsigned int ncolors = 0;
+  for (unsigned int round = 0; round < SYM_MAX_ROUNDS; round++) {
+    std::map<std::vector<unsigned int>, unsigned int> colors;
+    std::vector<unsigned int> next(n);
+    std::vector<unsigned int> key, cs;
+    for (unsigned int i = 0; i < n; i++) {
+      key.clear();
+      if (round == 0) {
+        key.push_back(std::get<1>(pkgs[i]));
+        key.push_back(std::get<2>(pkgs[i]));
+      } else {
+        key.push_back(color[i]);
+      }
+      for (unsigned int k = 0; k < SYM_NRELS; k++) {
+        const std::vector<unsigned int>& v = nb[SYM_NRELS * i + k];
+        key.push_back(v.size());
+        if (round == 0 || k == SYM_GROUP)
+          continue;
+        cs.clear();
+        for (unsigned int q : v)
+          cs.push_back(q == i ? NONE - 1 : (q < n ? color[q] : NONE));
+        std::sort(cs.begin(), cs.end());
+        key.insert(key.end(), cs.begin(), cs.end());
+      }
+      next[i] = colors.insert(std::make_pair(key, colors.size())).first->second;
+    }
+    color.swap(next);
+    if (colors.size() == ncolors)
+      break;
+    ncolors = colors.size();
+  }
+
+  // whether swapping packages i and j maps the problem onto itself
+  std::vector<unsigned int> s;
+  auto swappable = [&](unsigned int i, unsigned int j) -> bool {
+    if (std::get<1>(pkgs[i]) != std::get<1>(pkgs[j]) ||
+        std::get<2>(pkgs[i]) != std::get<2>(pkgs[j]))
+      return false;
+    for (unsigned int k = 0; k < SYM_NRELS; k++) {
+      const std::vector<unsigned int>& a = nb[SYM_NRELS * i + k];
+      const std::vector<unsigned int>& b = nb[SYM_NRELS * j + k];
+      if (a.size() != b.size())
+        return false;
+      if (k == SYM_GROUP) {
+        // groups with both packages are mapped onto themselves
+        if (a != b) return false;
+        continue;
+      }
+      s.assign(a.begin(), a.end());
+      for (unsigned int& x : s)
+        x = (x == i ? j : (x == j ? i : x));
+      std::sort(s.begin(), s.end());
+      if (s != b)
+        return false;
+    }
+    return true;
+  };
+
+  /*
+    Swaps are automorphisms and (a c) = (a b)(b c)(a b): a package belongs to
+    a class when it can be swapped with the first member.
+  */
+  std::vector<std::vector<unsigned int> > cells(ncolors);
+  for (auto& p : idx)
+    if (p.second < n && excl.count(p.first) == 0)
+      cells[color[p.second]].push_back(p.second);
+  unsigned int nc = 0;
+  std::vector<std::vector<unsigned int> > cls;
+  for (const std::vector<unsigned int>& cell : cells) {
+    if (cell.size() < 2)
+      continue;
+    cls.clear();
+    for (unsigned int i : cell) {
+      bool in = false;
+      for (size_t c = 0; c < cls.size() && !in; c++)
+        if (swappable(cls[c].front(), i)) {
+          cls[c].push_back(i);
+          in = true;
+        }
+      if (!in && cls.size() < SYM_MAX_CLASSES)
+        cls.push_back(std::vector<unsigned int>(1, i));
+    }
+    for (const std::vector<unsigned int>& c : cls) {
+      if (c.size() < 2)
+        continue;
+      ncls++;
+      for (size_t t = 1; t < c.size(); t++, nc++)
+        wrt.dependency(std::get<0>(pkgs[c[t]]), std::get<0>(pkgs[c[t - 1]]),
+                       "SYM");
+    }
+  }
+  clear();
+  return nc;
+}
@@ -0,0 +1,101 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__SYMMETRY__HH__
+#define __KCUDF__SYMMETRY__HH__
+
+#include <kcudf/kcudf.hh>
+#include <kcudf/swriter.hh>
+
+/**
+ * \file Symmetry breaking for interchangeable packages.
+ *
+ * Two packages are interchangeable when swapping them maps the problem onto
+ * itself: they have the same keep and install flags, and every relation of
+ * one of them is also a relation of the other one once both are swapped.
+ * Candidates are found by partition refinement: packages are colored by
+ * their flags and degrees, and colors are refined with the colors of the
+ * neighbours until they are stable. Interchangeability is then checked
+ * between packages of the same color.
+ *
+ * Every class p1 < p2 < ... < pn of pairwise interchangeable packages gets
+ * the lexicographic symmetry-breaking constraints p1 >= p2 >= ... >= pn,
+ * written as the dependencies "p(i+1) depends on p(i)". Every solution of
+ * the problem can be turned into one satisfying them with the same cost by
+ * swapping packages, so they only remove symmetric assignments from the
+ * search. The solutions need no translation back.
+ *
+ * The cost is the one of the written problem (changes of the install
+ * flags): criteria that tell interchangeable packages apart using the info
+ * file, like their versions, are not preserved. The packages those criteria
+ * look at (for instance the paranoid ones) can be excluded from the classes.
+ */
+
+/**
+ * \brief Writer that passes the problem it receives to \a wrt and adds
+ * symmetry-breaking constraints on \a flush.
+ */
+class KCudfSymmetryWriter final : public KCudfBufferWriter {
+private:
+  /// Classes of interchangeable packages found by \a flush
+  unsigned int ncls;
+  /// Packages that are never put in a class
+  std::set<unsigned int> excl;
+public:
+  /// Constructor for a writer passing the problem to \a w
+  KCudfSymmetryWriter(KCudfWriter& w);
+  /// Destructor
+  virtual ~KCudfSymmetryWriter(void);
+  void package(unsigned int p, bool keep, bool install, const char* desc);
+  void dependency(unsigned int p, unsigned int q, const char* desc);
+  void conflict(unsigned int p, unsigned int q, const char* desc);
+  void provides(unsigned int p, unsigned int q, const char* desc);
+  void atMostOne(const std::vector<unsigned int>& g, const char* desc);
+  /// Keeps package \a p out of the classes, it must be called before \a flush
+  void exclude(unsigned int p) {
+    excl.insert(p);
+  }
+  /**
+   * \brief Finds the interchangeable packages and writes the constraints
+   * breaking their symmetries. Returns the number of constraints, it can only
+   * be called once.
+   */
+  unsigned int flush(void);
+  /// Number of classes of interchangeable packages found by \a flush
+  unsigned int classes(void) const {
+    return ncls;
+  }
+};
+
+#endif
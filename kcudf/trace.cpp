@@ -0,0 +1,98 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <kcudf/trace.hh>
+
+namespace {
+  /// A recorded event
+  struct TraceEvent {
+    const char* name;
+    Trace::clock::time_point b, e;
+    unsigned int tid;
+  };
+  /// Whether events are being recorded
+  std::atomic<bool> on(false);
+  /// Protects all the data below
+  std::mutex mu;
+  /// Start of the recording
+  Trace::clock::time_point origin;
+  /// Recorded events
+  std::vector<TraceEvent> events;
+  /// Small identifiers for the threads, in order of their first event
+  std::map<std::thread::id, unsigned int> tids;
+}
+
+void Trace::start(void) {
+  std::lock_guard<std::mutex> lk(mu);
+  events.clear();
+  tids.clear();
+  origin = clock::now();
+  on = true;
+}
+
+bool Trace::recording(void) {
+  return on;
+}
+
+void Trace::event(const char* name, clock::time_point b, clock::time_point e) {
+  if (!on)
+    return;
+  std::lock_guard<std::mutex> lk(mu);
+  auto t = tids.insert(std::make_pair(std::this_thread::get_id(), tids.size()));
+  TraceEvent ev = {name, b, e, t.first->second};
+  events.push_back(ev);
+}
+
+void Trace::write(std::ostream& os) {
+  typedef std::chrono::duration<double, std::micro> us;
+  std::lock_guard<std::mutex> lk(mu);
+  on = false;
+  os << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  for (auto t = tids.begin(); t != tids.end(); ++t)
+    os << (t == tids.begin() ? "" : ",")
+       << "\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+       << t->second << ", \"args\": {\"name\": \"thread " << t->second << "\"}}";
+  for (const TraceEvent& ev : events)
+    os << ",\n  {\"name\": \"" << ev.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+       << ev.tid << ", \"ts\": " << us(ev.b - origin).count()
+       << ", \"dur\": " << us(ev.e - ev.b).count() << "}";
+  os << "\n]}\n";
+  events.clear();
+  tids.clear();
+}
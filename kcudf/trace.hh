@@ -0,0 +1,99 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__TRACE__HH__
+#define __KCUDF__TRACE__HH__
+
+#include <iostream>
+#include <chrono>
+
+/**
+ * \file Timeline of the execution in the chrome trace event format.
+ *
+ * Scoped events are declared with \a KCUDF_TRACE_SCOPE and are recorded, for
+ * every thread, between \a Trace::start and \a Trace::write. The output can
+ * be inspected with chrome://tracing or Perfetto.
+ *
+ * Events are only compiled when \a KCUDF_TRACE is defined (cmake option
+ * ENABLE_TRACE); otherwise \a KCUDF_TRACE_SCOPE expands to nothing.
+ */
+
+/**
+ * \brief Recorder of trace events.
+ */
+class Trace {
+public:
+  /// Clock used for the events
+  typedef std::chrono::steady_clock clock;
+  /// Starts recording events, previously recorded events are discarded
+  static void start(void);
+  /// Tests whether events are being recorded
+  static bool recording(void);
+  /// Records an event \a name that lasted from \a b to \a e on the calling thread
+  static void event(const char* name, clock::time_point b, clock::time_point e);
+  /// Stops recording and writes the recorded events on \a os
+  static void write(std::ostream& os);
+};
+
+/**
+ * \brief Records the scope where it is declared as an event.
+ */
+class TraceScope {
+private:
+  /// Name of the event
+  const char* name;
+  /// Start time
+  Trace::clock::time_point start;
+public:
+  /// Starts event \a n
+  TraceScope(const char* n)
+    : name(n), start(Trace::clock::now()) {}
+  /// Ends the event
+  ~TraceScope(void) {
+    Trace::event(name, start, Trace::clock::now());
+  }
+};
+
+#define KCUDF_TRACE_CAT_(a,b) a ## b
+#define KCUDF_TRACE_CAT(a,b) KCUDF_TRACE_CAT_(a,b)
+
+#ifdef KCUDF_TRACE
+/// Records the enclosing scope as event \a name
+#define KCUDF_TRACE_SCOPE(name) \
+  TraceScope KCUDF_TRACE_CAT(kcudf_trace_scope_, __LINE__)(name)
+#else
+#define KCUDF_TRACE_SCOPE(name)
+#endif
+
+#endif
@@ -0,0 +1,212 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__WORKLIST__HH__
+#define __KCUDF__WORKLIST__HH__
+
+#include <list>
+#include <vector>
+#include <tuple>
+#include <string>
+#include <algorithm>
+#include <cassert>
+#include <kcudf/memory.hh>
+
+/**
+ * \file Worklists with a selectable scheduling policy. The reducer keeps its
+ * pending tasks in them and the policy decides the order in which they are
+ * run, which changes the work needed to reach the fixed point.
+ */
+
+/**
+ * \brief Scheduling policies of a worklist.
+ */
+enum WL_POLICY {
+  WLP_FIFO = 0, ///> First in, first out
+  WLP_LIFO,     ///> Last in, first out
+  WLP_DEGREE,   ///> Highest key first, first in first out among equal keys
+  WLP_BUCKET    ///> Lowest key first, first in first out among equal keys
+};
+
+/// Number of scheduling policies
+const unsigned int WLP_NPOLICIES = WLP_BUCKET + 1;
+
+/// Name of policy \a p
+inline const char* policyName(WL_POLICY p) {
+  static const char* names[WLP_NPOLICIES] = {"fifo", "lifo", "degree", "bucket"};
+  return names[p];
+}
+
+/**
+ * \brief Stores in \a p the policy named \a n. Returns false if there is no
+ * such policy.
+ */
+inline bool policyFromName(const std::string& n, WL_POLICY& p) {
+  for (unsigned int i = 0; i < WLP_NPOLICIES; i++)
+    if (n == policyName(static_cast<WL_POLICY>(i))) {
+      p = static_cast<WL_POLICY>(i);
+      return true;
+    }
+  return false;
+}
+
+/**
+ * \brief Worklist of tasks of type \a T.
+ *
+ * Every task is pushed with a key, only used by the policies that order by
+ * it: \a WLP_DEGREE runs the tasks with the highest key first (the key is
+ * meant to be the degree of the package) and \a WLP_BUCKET the tasks with
+ * the lowest one (the key is a small bucket index, like the operation).
+ */
+template <class T>
+class Worklist {
+private:
+  /// Entry of the heap: key, sequence number and task
+  typedef std::tuple<unsigned int, unsigned long, T> entry_t;
+  /// Order of the heap: highest key first, then lowest sequence number
+  static bool before(const entry_t& a, const entry_t& b) {
+    return std::get<0>(a) < std::get<0>(b) ||
+      (std::get<0>(a) == std::get<0>(b) && std::get<1>(a) > std::get<1>(b));
+  }
+  /// Scheduling policy
+  WL_POLICY pol;
+  /// Tasks of the fifo and lifo policies
+  std::list<T> tasks;
+  /// Tasks of the degree policy
+  std::vector<entry_t> heap;
+  /// Tasks of the bucket policy, indexed by key
+  std::vector<std::list<T> > buckets;
+  /// No bucket below this one has tasks
+  unsigned int low;
+  /// Number of tasks pushed, used to break ties in the heap
+  unsigned long seq;
+  /// Number of pending tasks
+  size_t n;
+public:
+  /// Constructor of an empty worklist with policy \a p
+  Worklist(WL_POLICY p = WLP_FIFO) : pol(p), low(0), seq(0), n(0) {}
+  /// Return the scheduling policy
+  WL_POLICY policy(void) const { return pol; }
+  /**
+   * \brief Changes the scheduling policy to \a p.
+   *
+   * \warning The worklist must be empty
+   */
+  void policy(WL_POLICY p) {
+    assert(empty());
+    pol = p;
+  }
+  /// Tests whether there are pending tasks
+  bool empty(void) const { return n == 0; }
+  /// Number of pending tasks
+  size_t size(void) const { return n; }
+  /// Adds task \a t with key \a k
+  void push(const T& t, unsigned int k = 0) {
+    switch (pol) {
+    case WLP_FIFO:
+    case WLP_LIFO:
+      tasks.push_back(t);
+      break;
+    case WLP_DEGREE:
+      heap.push_back(std::make_tuple(k, seq++, t));
+      std::push_heap(heap.begin(), heap.end(), before);
+      break;
+    case WLP_BUCKET:
+      if (k >= buckets.size())
+        buckets.resize(k + 1);
+      buckets[k].push_back(t);
+      low = std::min(low, k);
+      break;
+    }
+    n++;
+  }
+  /**
+   * \brief Removes and returns the next task according to the policy.
+   *
+   * \warning The worklist must not be empty
+   */
+  T pop(void) {
+    assert(!empty());
+    T t;
+    switch (pol) {
+    case WLP_FIFO:
+      t = tasks.front();
+      tasks.pop_front();
+      break;
+    case WLP_LIFO:
+      t = tasks.back();
+      tasks.pop_back();
+      break;
+    case WLP_DEGREE:
+      std::pop_heap(heap.begin(), heap.end(), before);
+      t = std::get<2>(heap.back());
+      heap.pop_back();
+      break;
+    case WLP_BUCKET:
+      while (buckets[low].empty())
+        low++;
+      t = buckets[low].front();
+      buckets[low].pop_front();
+      break;
+    }
+    n--;
+    return t;
+  }
+  /// Calls \a f on every pending task, in no particular order
+  template <class F>
+  void forEach(F f) const {
+    for (const T& t : tasks)
+      f(t);
+    for (const entry_t& e : heap)
+      f(std::get<2>(e));
+    for (const std::list<T>& b : buckets)
+      for (const T& t : b)
+        f(t);
+  }
+  /// Heap bytes used by the worklist (not by the tasks)
+  size_t bytes(void) const {
+    size_t b = heapBytes(tasks) + heapBytes(heap) + heapBytes(buckets);
+    for (const std::list<T>& l : buckets)
+      b += heapBytes(l);
+    return b;
+  }
+};
+
+/// Heap bytes of worklist \a w (not of its tasks)
+template <class T>
+inline size_t heapBytes(const Worklist<T>& w) {
+  return w.bytes();
+}
+
+#endif
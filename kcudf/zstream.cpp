@@ -0,0 +1,510 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <deque>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <kcudf/zstream.hh>
+#ifdef KCUDF_ZLIB
+#include <zlib.h>
+#endif
+#ifdef KCUDF_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+  /// Size of the buffers used for (de)compression
+  const size_t CHUNK = 1 << 16;
+  /// Size of the chunks passed to the compression thread
+  const size_t OUT_CHUNK = 1 << 20;
+  /// Maximum number of chunks waiting to be compressed
+  const size_t MAX_QUEUED = 4;
+
+  /*
+   * Decompression
+   */
+
+  /// Buffer decompressing the content of a file
+  class DecompressBuf : public std::streambuf {
+  private:
+    /// Compressed data read from the file
+    std::vector<char> in;
+  protected:
+    /// File being read
+    FILE *f;
+    /// Decompressed data
+    std::vector<char> out;
+    /// Compressed data not yet decompressed
+    const char *inp;
+    /// Size of the compressed data not yet decompressed
+    size_t inn;
+    /// Whether the last decompressed byte ended a compressed frame
+    bool end;
+    /// Decompresses pending input into \a out, returns the produced bytes
+    virtual size_t decode(void) = 0;
+    /// Reads more input if all the pending input was used
+    bool fill(void) {
+      if (inn == 0 && !feof(f)) {
+        inn = fread(in.data(), 1, in.size(), f);
+        inp = in.data();
+        if (ferror(f))
+          throw std::ios_base::failure("error reading compressed file");
+      }
+      return inn > 0;
+    }
+    virtual int_type underflow(void) {
+      if (gptr() < egptr())
+        return traits_type::to_int_type(*gptr());
+      for (;;) {
+        bool more = fill();
+        size_t n = decode();
+        if (n > 0) {
+          setg(out.data(), out.data(), out.data() + n);
+          return traits_type::to_int_type(*gptr());
+        }
+        if (!more) {
+          if (!end)
+            throw std::ios_base::failure("truncated compressed file");
+          return traits_type::eof();
+        }
+      }
+    }
+  public:
+    DecompressBuf(FILE *file)
+      : in(CHUNK), f(file), out(CHUNK), inp(NULL), inn(0), end(false) {}
+    virtual ~DecompressBuf(void) {
+      fclose(f);
+    }
+  };
+
+#ifdef KCUDF_ZLIB
+  /// Buffer decompressing a gzip file (possibly with several members)
+  class GzipInBuf : public DecompressBuf {
+  private:
+    z_stream zs;
+  protected:
+    virtual size_t decode(void) {
+      zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(inp));
+      zs.avail_in = inn;
+      zs.next_out = reinterpret_cast<Bytef*>(out.data());
+      zs.avail_out = out.size();
+      int r = inflate(&zs, Z_NO_FLUSH);
+      size_t consumed = inn - zs.avail_in;
+      inp += consumed;
+      inn = zs.avail_in;
+      if (r == Z_STREAM_END) {
+        end = true;
+        inflateReset(&zs);
+      } else if (r != Z_OK && r != Z_BUF_ERROR) {
+        throw std::ios_base::failure(zs.msg ? zs.msg : "corrupted gzip file");
+      } else if (consumed > 0) {
+        end = false;
+      }
+      return out.size() - zs.avail_out;
+    }
+  public:
+    GzipInBuf(FILE *file) : DecompressBuf(file) {
+      std::memset(&zs, 0, sizeof(zs));
+      inflateInit2(&zs, 15 + 16);
+    }
+    virtual ~GzipInBuf(void) {
+      inflateEnd(&zs);
+    }
+  };
+#endif
+
+#ifdef KCUDF_ZSTD
+  /// Buffer decompressing a zstd file (possibly with several frames)
+  class ZstdInBuf : public DecompressBuf {
+  private:
+    ZSTD_DStream *ds;
+  protected:
+    virtual size_t decode(void) {
+      ZSTD_inBuffer ib = {inp, inn, 0};
+      ZSTD_outBuffer ob = {out.data(), out.size(), 0};
+      size_t r = ZSTD_decompressStream(ds, &ob, &ib);
+      if (ZSTD_isError(r))
+        throw std::ios_base::failure(ZSTD_getErrorName(r));
+      inp += ib.pos;
+      inn -= ib.pos;
+      // a call without input nor output says nothing about the frame
+      if (ib.pos > 0 || ob.pos > 0)
+        end = (r == 0);
+      return ob.pos;
+    }
+  public:
+    ZstdInBuf(FILE *file) : DecompressBuf(file), ds(ZSTD_createDStream()) {
+      ZSTD_initDStream(ds);
+    }
+    virtual ~ZstdInBuf(void) {
+      ZSTD_freeDStream(ds);
+    }
+  };
+#endif
+
+  /*
+   * Compression
+   */
+
+  /// Compressor writing to a file
+  class Encoder {
+  public:
+    virtual ~Encoder(void) {}
+    /**
+     * \brief Compresses \a n bytes of \a d and writes them to \a f. If \a last
+     * the compressed stream is finished. Returns false on write errors.
+     */
+    virtual bool encode(const char* d, size_t n, bool last, FILE *f) = 0;
+  };
+
+#ifdef KCUDF_ZLIB
+  class GzipEncoder : public Encoder {
+  private:
+    z_stream zs;
+    std::vector<char> out;
+  public:
+    GzipEncoder(void) : out(CHUNK) {
+      std::memset(&zs, 0, sizeof(zs));
+      deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8,
+                   Z_DEFAULT_STRATEGY);
+    }
+    virtual ~GzipEncoder(void) {
+      deflateEnd(&zs);
+    }
+    virtual bool encode(const char* d, size_t n, bool last, FILE *f) {
+      zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(d));
+      zs.avail_in = n;
+      do {
+        zs.next_out = reinterpret_cast<Bytef*>(out.data());
+        zs.avail_out = out.size();
+        deflate(&zs, last ? Z_FINISH : Z_NO_FLUSH);
+        size_t w = out.size() - zs.avail_out;
+        if (fwrite(out.data(), 1, w, f) != w)
+          return false;
+      } while (zs.avail_out == 0);
+      return true;
+    }
+  };
+#endif
+
+#ifdef KCUDF_ZSTD
+  class ZstdEncoder : public Encoder {
+  private:
+    ZSTD_CStream *cs;
+    std::vector<char> out;
+    bool write(ZSTD_outBuffer& ob, FILE *f) {
+      return fwrite(ob.dst, 1, ob.pos, f) == ob.pos;
+    }
+  public:
+    ZstdEncoder(void) : cs(ZSTD_createCStream()), out(CHUNK) {
+      ZSTD_initCStream(cs, 3);
+    }
+    virtual ~ZstdEncoder(void) {
+      ZSTD_freeCStream(cs);
+    }
+    virtual bool encode(const char* d, size_t n, bool last, FILE *f) {
+      ZSTD_inBuffer ib = {d, n, 0};
+      while (ib.pos < ib.size) {
+        ZSTD_outBuffer ob = {out.data(), out.size(), 0};
+        if (ZSTD_isError(ZSTD_compressStream(cs, &ob, &ib)) || !write(ob, f))
+          return false;
+      }
+      if (last) {
+        size_t r;
+        do {
+          ZSTD_outBuffer ob = {out.data(), out.size(), 0};
+          r = ZSTD_endStream(cs, &ob);
+          if (ZSTD_isError(r) || !write(ob, f))
+            return false;
+        } while (r > 0);
+      }
+      return true;
+    }
+  };
+#endif
+
+  /**
+   * \brief Buffer compressing its content on a separate thread.
+   *
+   * Data is passed to the thread in chunks of \a OUT_CHUNK bytes. At most \a
+   * MAX_QUEUED chunks wait to be compressed, after that the writer blocks.
+   */
+  class CompressBuf : public std::streambuf {
+  private:
+    FILE *f;
+    std::unique_ptr<Encoder> enc;
+    /// Chunk being filled
+    std::vector<char> cur;
+    /// Chunks waiting to be compressed
+    std::deque<std::vector<char> > q;
+    /// Chunks already compressed, to be reused
+    std::vector<std::vector<char> > pool;
+    std::mutex mu;
+    std::condition_variable cv;
+    /// No more chunks will be added
+    bool closing;
+    /// Whether some write failed
+    bool failed;
+    std::thread worker;
+    /// Passes the current chunk to the compression thread
+    void push(void) {
+      size_t n = pptr() - pbase();
+      if (n == 0)
+        return;
+      cur.resize(n);
+      {
+        std::unique_lock<std::mutex> lk(mu);
+        cv.wait(lk, [this] { return q.size() < MAX_QUEUED; });
+        q.push_back(std::move(cur));
+        if (pool.empty()) {
+          cur = std::vector<char>(OUT_CHUNK);
+        } else {
+          cur = std::move(pool.back());
+          pool.pop_back();
+          cur.resize(OUT_CHUNK);
+        }
+      }
+      cv.notify_all();
+      setp(cur.data(), cur.data() + cur.size());
+    }
+    /// Compression thread
+    void run(void) {
+      for (;;) {
+        std::vector<char> c;
+        {
+          std::unique_lock<std::mutex> lk(mu);
+          cv.wait(lk, [this] { return !q.empty() || closing; });
+          if (q.empty())
+            break;
+          c = std::move(q.front());
+          q.pop_front();
+        }
+        cv.notify_all();
+        if (!enc->encode(c.data(), c.size(), false, f))
+          failed = true;
+        std::lock_guard<std::mutex> lk(mu);
+        pool.push_back(std::move(c));
+      }
+      if (!enc->encode(NULL, 0, true, f))
+        failed = true;
+    }
+  protected:
+    virtual int_type overflow(int_type c) {
+      push();
+      if (!traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+      }
+      return traits_type::not_eof(c);
+    }
+    virtual int sync(void) {
+      push();
+      return 0;
+    }
+  public:
+    CompressBuf(FILE *file, Encoder *e)
+      : f(file), enc(e), cur(OUT_CHUNK), closing(false), failed(false) {
+      setp(cur.data(), cur.data() + cur.size());
+      worker = std::thread(&CompressBuf::run, this);
+    }
+    /// Compresses the pending data and closes the file, returns false on errors
+    bool close(void) {
+      if (f == NULL)
+        return !failed;
+      push();
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        closing = true;
+      }
+      cv.notify_all();
+      worker.join();
+      if (fclose(f) != 0)
+        failed = true;
+      f = NULL;
+      return !failed;
+    }
+    virtual ~CompressBuf(void) {
+      close();
+    }
+  };
+}
+
+COMPRESSION compressionOf(const char* fname) {
+  size_t n = std::strlen(fname);
+  if (n >= 3 && std::strcmp(fname + n - 3, ".gz") == 0)
+    return CMP_GZIP;
+  if (n >= 4 && std::strcmp(fname + n - 4, ".zst") == 0)
+    return CMP_ZSTD;
+  return CMP_NONE;
+}
+
+bool compressionAvailable(COMPRESSION c) {
+  switch (c) {
+  case CMP_NONE:
+    return true;
+  case CMP_GZIP:
+#ifdef KCUDF_ZLIB
+    return true;
+#else
+    return false;
+#endif
+  case CMP_ZSTD:
+#ifdef KCUDF_ZSTD
+    return true;
+#else
+    return false;
+#endif
+  }
+  return false;
+}
+
+/*
+ * InputFile
+ */
+InputFile::InputFile(const char* fname)
+  : std::istream(NULL), cmp(CMP_NONE) {
+  FILE *f = fopen(fname, "rb");
+  if (f == NULL) {
+    setstate(std::ios::failbit);
+    return;
+  }
+  unsigned char m[4] = {0, 0, 0, 0};
+  size_t n = fread(m, 1, 4, f);
+  rewind(f);
+  if (n >= 2 && m[0] == 0x1f && m[1] == 0x8b)
+    cmp = CMP_GZIP;
+  else if (n == 4 && m[0] == 0x28 && m[1] == 0xb5 && m[2] == 0x2f && m[3] == 0xfd)
+    cmp = CMP_ZSTD;
+
+  switch (cmp) {
+  case CMP_NONE: {
+    fclose(f);
+    std::filebuf *fb = new std::filebuf();
+    buf.reset(fb);
+    if (!fb->open(fname, std::ios::in))
+      f = NULL;
+    break;
+  }
+  case CMP_GZIP:
+#ifdef KCUDF_ZLIB
+    buf.reset(new GzipInBuf(f));
+#else
+    fclose(f);
+    f = NULL;
+#endif
+    break;
+  case CMP_ZSTD:
+#ifdef KCUDF_ZSTD
+    buf.reset(new ZstdInBuf(f));
+#else
+    fclose(f);
+    f = NULL;
+#endif
+    break;
+  }
+  if (f == NULL) {
+    setstate(std::ios::failbit);
+    return;
+  }
+  rdbuf(buf.get());
+  // errors in compressed data are reported instead of ending the input
+  exceptions(std::ios::badbit);
+}
+
+InputFile::~InputFile(void) {}
+
+COMPRESSION InputFile::compression(void) const {
+  return cmp;
+}
+
+/*
+ * OutputFile
+ */
+OutputFile::OutputFile(const char* fname)
+  : OutputFile(fname, compressionOf(fname)) {}
+
+OutputFile::OutputFile(const char* fname, COMPRESSION c)
+  : std::ostream(NULL) {
+  Encoder *e = NULL;
+  switch (c) {
+  case CMP_NONE: {
+    std::filebuf *fb = new std::filebuf();
+    buf.reset(fb);
+    if (!fb->open(fname, std::ios::out | std::ios::trunc))
+      buf.reset();
+    break;
+  }
+  case CMP_GZIP:
+#ifdef KCUDF_ZLIB
+    e = new GzipEncoder();
+#endif
+    break;
+  case CMP_ZSTD:
+#ifdef KCUDF_ZSTD
+    e = new ZstdEncoder();
+#endif
+    break;
+  }
+  if (e != NULL) {
+    FILE *f = fopen(fname, "wb");
+    if (f == NULL)
+      delete e;
+    else
+      buf.reset(new CompressBuf(f, e));
+  }
+  if (buf)
+    rdbuf(buf.get());
+  else
+    setstate(std::ios::failbit);
+}
+
+OutputFile::~OutputFile(void) {
+  close();
+}
+
+void OutputFile::close(void) {
+  if (!buf)
+    return;
+  std::filebuf *fb = dynamic_cast<std::filebuf*>(buf.get());
+  if (fb != NULL && !fb->is_open())
+    return;
+  bool ok = fb ? fb->close() != NULL : static_cast<CompressBuf*>(buf.get())->close();
+  if (!ok)
+    setstate(std::ios::badbit);
+}
@@ -0,0 +1,113 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __KCUDF__ZSTREAM__HH__
+#define __KCUDF__ZSTREAM__HH__
+
+#include <iostream>
+#include <memory>
+
+/**
+ * \file Streams on possibly compressed files.
+ *
+ * Input files are decompressed on the fly when they start with the magic
+ * bytes of gzip or zstd. Output files are compressed when their name ends in
+ * ".gz" or ".zst"; compression runs on a separate thread so it overlaps with
+ * the generation of the output.
+ *
+ * gzip is available when the library is built with zlib (\a KCUDF_ZLIB) and
+ * zstd when it is built with libzstd (\a KCUDF_ZSTD). Using a format that is
+ * not available fails the stream.
+ */
+
+/// Compression formats
+enum COMPRESSION {
+  CMP_NONE = 0, ///> No compression
+  CMP_GZIP,     ///> gzip (deflate)
+  CMP_ZSTD      ///> zstd
+};
+
+/// Returns the compression implied by the extension of file \a fname
+COMPRESSION compressionOf(const char* fname);
+
+/// Tests whether compression format \a c is available
+bool compressionAvailable(COMPRESSION c);
+
+/**
+ * \brief Input stream on a file that is decompressed if needed.
+ *
+ * The stream fails if the file cannot be opened or if it is compressed in a
+ * format that is not available. Corrupted compressed data throws
+ * std::ios_base::failure when read.
+ */
+class InputFile : public std::istream {
+private:
+  /// Buffer reading (and decompressing) the file
+  std::unique_ptr<std::streambuf> buf;
+  /// Compression detected on the file
+  COMPRESSION cmp;
+public:
+  /// Opens file \a fname for input
+  InputFile(const char* fname);
+  /// Destructor
+  virtual ~InputFile(void);
+  /// Returns the compression of the file
+  COMPRESSION compression(void) const;
+};
+
+/**
+ * \brief Output stream on a file that is compressed according to its name.
+ *
+ * The stream fails if the file cannot be opened or if the requested
+ * compression is not available.
+ */
+class OutputFile : public std::ostream {
+private:
+  /// Buffer writing (and compressing) the file
+  std::unique_ptr<std::streambuf> buf;
+public:
+  /// Opens file \a fname for output, compressed as \a compressionOf(fname)
+  OutputFile(const char* fname);
+  /// Opens file \a fname for output compressed in format \a c
+  OutputFile(const char* fname, COMPRESSION c);
+  /// Destructor, closes the file
+  virtual ~OutputFile(void);
+  /**
+   * \brief Flushes all the data, waits for the compression to finish and
+   * closes the file.
+   */
+  void close(void);
+};
+
+#endif
@@ -0,0 +1,266 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#ifndef __KCUDF__BRUTE__HH__
+#define __KCUDF__BRUTE__HH__
+
+#include <random>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <kcudf/swriter.hh>
+#include <kcudf/merge.hh>
+#include <kcudf/reduce.hh>
+
+/**
+ * \file Brute force checking of small kcudf problems for the tests.
+ *
+ * A set of installed packages is a solution when the packages marked keep
+ * have their install state, the dependencies of the installed packages are
+ * installed, no two installed packages conflict or are in the same
+ * at-most-one group, and every installed package that is provided by some
+ * package has one of its providers installed (as encoded by \a
+ * KCudfSatWriter).
+ */
+
+/// Set of installed packages
+typedef std::set<unsigned int> installed_t;
+
+/**
+ * \brief Problem stored in memory that is solved by enumerating all the
+ * install states of its packages.
+ */
+class BruteProblem : public KCudfMemWriter {
+private:
+  /// Providers of every provided package
+  std::map<unsigned int, std::set<unsigned int> > pvdrs;
+public:
+  void provides(unsigned int p, unsigned int q, const char* desc) {
+    KCudfMemWriter::provides(p, q, desc);
+    pvdrs[q].insert(p);
+  }
+  /// Returns the packages of the problem
+  const std::set<unsigned int>& ids(void) const {
+    return packages;
+  }
+  /// Returns the packages marked install in the problem
+  const installed_t& installed(void) const {
+    return installs;
+  }
+  /// Tests whether \a s is a solution
+  bool solution(const installed_t& s) const {
+    for (unsigned int p : packages)
+      if (keeps.count(p) > 0 && (s.count(p) > 0) != (installs.count(p) > 0))
+        return false;
+    for (unsigned int p : s) {
+      auto d = deps.find(p);
+      if (d != deps.end())
+        for (unsigned int q : d->second)
+          if (s.count(q) == 0) return false;
+      auto c = confs.find(p);
+      if (c != confs.end())
+        for (unsigned int q : c->second)
+          if (s.count(q) > 0) return false;
+      auto v = pvdrs.find(p);
+      if (v != pvdrs.end()) {
+        bool provided = false;
+        for (unsigned int q : v->second)
+          provided = provided || s.count(q) > 0;
+        if (!provided) return false;
+      }
+    }
+    return true;
+  }
+  /// Number of packages not marked keep whose install state changes in \a s
+  unsigned int changes(const installed_t& s) const {
+    unsigned int n = 0;
+    for (unsigned int p : packages)
+      if (keeps.count(p) == 0 && (s.count(p) > 0) != (installs.count(p) > 0))
+        n++;
+    return n;
+  }
+  /// Calls \a f for every solution
+  void solutions(std::function<void(const installed_t&)> f) const {
+    std::vector<unsigned int> ps(packages.begin(), packages.end());
+    for (unsigned long m = 0; m < (1ul << ps.size()); m++) {
+      installed_t s;
+      for (size_t i = 0; i < ps.size(); i++)
+        if (m & (1ul << i)) s.insert(ps[i]);
+      if (solution(s))
+        f(s);
+    }
+  }
+};
+
+/**
+ * \brief Writes to \a wrt a random problem with \a bases base packages (from
+ * 3 to 6 if it is 0), the same for the same \a seed.
+ *
+ * Some packages get clones with the same flags and relations, so that the
+ * problem has equivalent and interchangeable packages. A few clones differ in
+ * one flag and a few relations are added between single packages.
+ */
+inline void randomProblem(KCudfWriter& wrt, unsigned int seed,
+                          unsigned int bases = 0) {
+  std::mt19937 rng(seed);
+  auto chance = [&](double p) {
+    return std::uniform_real_distribution<double>(0, 1)(rng) < p;
+  };
+  unsigned int nb = bases > 0 ? bases : 3 + rng() % 4;
+  // clones of every base package
+  std::vector<std::vector<unsigned int> > cl(nb);
+  std::vector<unsigned int> all;
+  for (unsigned int b = 0; b < nb; b++) {
+    unsigned int n = chance(0.4) ? 2 + rng() % 2 : 1;
+    bool keep = chance(0.2), install = chance(0.4);
+    for (unsigned int i = 0; i < n; i++) {
+      cl[b].push_back(all.size());
+      // now and then a clone differs in one flag
+      bool k = keep != (i > 0 && chance(0.1));
+      bool in = install != (i > 0 && chance(0.1));
+      wrt.package(all.size(), k, in, "");
+      all.push_back(all.size());
+    }
+  }
+  for (unsigned int a = 0; a < nb; a++) {
+    if (chance(0.7))
+      for (unsigned int p : cl[a])
+        wrt.provides(p, p, "");
+    for (unsigned int b = 0; b < nb; b++) {
+      if (a == b) continue;
+      bool dep = chance(0.2), conf = a < b && chance(0.15), pvd = chance(0.15);
+      for (unsigned int p : cl[a])
+        for (unsigned int q : cl[b]) {
+          if (dep) wrt.dependency(p, q, "");
+          if (conf) wrt.conflict(p, q, "");
+          if (pvd) wrt.provides(p, q, "");
+        }
+    }
+  }
+  // a few relations of single packages, so that not all the clones stay
+  // equivalent
+  for (unsigned int i = rng() % 3; i > 0; i--) {
+    unsigned int p = rng() % all.size(), q = rng() % all.size();
+    if (p == q) continue;
+    switch (rng() % 3) {
+    case 0: wrt.dependency(p, q, ""); break;
+    case 1: wrt.conflict(p, q, ""); break;
+    default: wrt.provides(p, q, ""); break;
+    }
+  }
+  if (chance(0.3) && all.size() > 2) {
+    std::vector<unsigned int> g;
+    for (unsigned int p : all)
+      if (chance(0.3)) g.push_back(p);
+    if (g.size() > 1)
+      wrt.atMostOne(g, "");
+  }
+}
+
+/**
+ * \brief Transformation that writes to \a wrt the problem generated from \a
+ * seed with classes of packages replaced by their representative, and stores
+ * the classes in \a m.
+ */
+typedef std::function<void(KCudfWriter& wrt, unsigned int seed,
+                           KCudfMerging& m)> transform_t;
+
+/**
+ * \brief Checks transformation \a tr on the problem generated from \a seed.
+ *
+ * The transformed problem must be satisfiable exactly when the original one
+ * is, and every solution of it must be a solution of the original one once
+ * the members of the classes \a follows selects are installed with their
+ * representative. The transformed problem is called \a what in the messages
+ * and the number of members of the classes is added to \a members.
+ */
+inline bool checkExpansion(unsigned int seed, const char* what,
+                           transform_t tr,
+                           std::function<bool(const KCudfMerging::Class&)> follows,
+                           unsigned int& members) {
+  BruteProblem orig, trp;
+  randomProblem(orig, seed);
+  KCudfMerging m;
+  tr(trp, seed, m);
+  members += m.merged();
+  bool sat = false, tsat = false, sound = true;
+  orig.solutions([&](const installed_t&) { sat = true; });
+  trp.solutions([&](const installed_t& s) {
+      tsat = true;
+      installed_t e(s);
+      for (unsigned int p : s) {
+        const KCudfMerging::Class* c = m.find(p);
+        if (c != NULL && follows(*c))
+          e.insert(c->members.begin(), c->members.end());
+      }
+      sound = sound && orig.solution(e);
+    });
+  if (sat != tsat)
+    std::cerr << "seed " << seed << ": the original problem is "
+              << (sat ? "" : "not ") << "satisfiable, the " << what
+              << " one is " << (tsat ? "" : "not ") << "satisfiable"
+              << std::endl;
+  if (!sound)
+    std::cerr << "seed " << seed << ": a " << what << " solution does not "
+              << "expand to an original solution" << std::endl;
+  return sat == tsat && sound;
+}
+
+/**
+ * \brief Reduces the kcudf text \a problem with a reducer configured by \a
+ * setup and returns the outcome. The solved and search parts are stored in \a
+ * solved and \a search and the statistics in \a st (if it is not NULL).
+ */
+inline KCudfReducer::RD_OUT
+reduceText(const std::string& problem, std::function<void(KCudfReducer&)> setup,
+           std::string& solved, std::string& search, ReducerStats* st = NULL) {
+  KCudfReducer red;
+  setup(red);
+  std::istringstream is(problem);
+  read(is, red);
+  std::ostringstream sv, sr;
+  KCudfReducer::RD_OUT out;
+  {
+    KCudfFileWriter sw(sv), rw(sr);
+    out = red.reduce(sw, rw);
+  }
+  solved = sv.str();
+  search = sr.str();
+  if (st != NULL)
+    *st = red.stats();
+  return out;
+}
+
+#endif
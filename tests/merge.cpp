@@ -0,0 +1,67 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/merge.hh>
+#include "brute.hh"
+
+/**
+ * \file Merging of equivalent packages on small random problems.
+ *
+ * The merged problem must be satisfiable exactly when the original one is,
+ * and every solution of the merged problem, expanded as \a
+ * KCudfExpandWriter does, must be a solution of the original one.
+ */
+
+int main(void) {
+  transform_t tr = [](KCudfWriter& wrt, unsigned int seed, KCudfMerging& m) {
+    KCudfMergeWriter mw(wrt);
+    randomProblem(mw, seed);
+    mw.flush(m);
+  };
+  bool ok = true;
+  unsigned int merged = 0;
+  for (unsigned int seed = 0; seed < 1000; seed++)
+    // the members of a class follow the representative only if it says so
+    ok = checkExpansion(seed, "merged", tr,
+                        [](const KCudfMerging::Class& c) { return c.all; },
+                        merged) && ok;
+  if (merged == 0) {
+    std::cerr << "no package was merged" << std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
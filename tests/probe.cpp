@@ -0,0 +1,118 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/reduce.hh>
+#include "brute.hh"
+
+/**
+ * \file Probing stage of the reducer on small random problems.
+ *
+ * The solved and search parts written with probing must be satisfiable
+ * exactly when the ones written without it are, and their solutions must be
+ * solutions of the parts written without it. Probing can also find that the
+ * problem has no solution.
+ */
+
+namespace {
+  /// Loads the solved and search parts \a solved and \a search into \a p
+  void load(BruteProblem& p, const std::string& solved,
+            const std::string& search) {
+    std::istringstream is(solved + search);
+    read(is, p);
+  }
+
+  /// Checks the probing of the problem generated from \a seed
+  bool check(unsigned int seed, unsigned long& failed) {
+    std::ostringstream os;
+    {
+      KCudfFileWriter wrt(os);
+      randomProblem(wrt, seed);
+    }
+    std::string solved, search;
+    KCudfReducer::RD_OUT out =
+      reduceText(os.str(), [](KCudfReducer&) {}, solved, search);
+    BruteProblem red;
+    bool sat = false;
+    if (out != KCudfReducer::RDO_FAIL) {
+      load(red, solved, search);
+      red.solutions([&](const installed_t&) { sat = true; });
+    }
+
+    ReducerStats st;
+    KCudfReducer::RD_OUT pout =
+      reduceText(os.str(), [](KCudfReducer& r) { r.probing(2); },
+                 solved, search, &st);
+    failed += st.probe_failed;
+    if (pout == KCudfReducer::RDO_FAIL) {
+      if (sat)
+        std::cerr << "seed " << seed << ": probing fails on a satisfiable "
+                  << "problem" << std::endl;
+      return !sat;
+    }
+    BruteProblem prb;
+    load(prb, solved, search);
+    bool psat = false, sound = true;
+    prb.solutions([&](const installed_t& s) {
+        psat = true;
+        sound = sound && red.solution(s);
+      });
+    if (sat != psat)
+      std::cerr << "seed " << seed << ": the reduced problem is "
+                << (sat ? "" : "not ") << "satisfiable, the probed one is "
+                << (psat ? "" : "not ") << "satisfiable" << std::endl;
+    else if (!sound)
+      std::cerr << "seed " << seed << ": a probed solution is not a solution "
+                << "of the reduced problem" << std::endl;
+    return sat == psat && sound;
+  }
+}
+
+int main(void) {
+  // the reducer reports its progress on the standard output
+  std::ostringstream sink;
+  std::streambuf *cout_buf = std::cout.rdbuf(sink.rdbuf());
+  bool ok = true;
+  unsigned long failed = 0;
+  for (unsigned int seed = 0; seed < 1000; seed++)
+    ok = check(seed, failed) && ok;
+  std::cout.rdbuf(cout_buf);
+  if (failed == 0) {
+    std::cerr << "no probe failed" << std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,95 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/reduce.hh>
+#include <kcudf/swriter.hh>
+#include "brute.hh"
+
+/**
+ * \file Scheduling policies of the reducer on random problems.
+ *
+ * The policies only order the can operations, which must not change the
+ * fixed point: every policy has to write the same solved and search parts
+ * as the fifo one.
+ */
+
+namespace {
+  /// Reduces \a problem with policy \a p and returns the sorted output lines
+  std::vector<std::string> reduce(const std::string& problem, WL_POLICY p) {
+    std::string solved, search;
+    reduceText(problem, [p](KCudfReducer& red) { red.scheduling(p); },
+               solved, search);
+    std::vector<std::string> lines;
+    std::istringstream out(solved + search);
+    std::string l;
+    while (std::getline(out, l))
+      lines.push_back(l);
+    std::sort(lines.begin(), lines.end());
+    return lines;
+  }
+
+  /// Checks the policies on the problem generated from \a seed
+  bool check(unsigned int seed) {
+    std::ostringstream os;
+    {
+      KCudfFileWriter wrt(os);
+      randomProblem(wrt, seed, 10 + seed % 30);
+    }
+    const std::vector<std::string> fifo = reduce(os.str(), WLP_FIFO);
+    bool ok = true;
+    for (unsigned int i = WLP_FIFO + 1; i < WLP_NPOLICIES; i++) {
+      WL_POLICY p = static_cast<WL_POLICY>(i);
+      if (reduce(os.str(), p) != fifo) {
+        std::cerr << "seed " << seed << ": policy " << policyName(p)
+                  << " reaches another fixed point than fifo" << std::endl;
+        ok = false;
+      }
+    }
+    return ok;
+  }
+}
+
+int main(void) {
+  // the reducer reports its progress on the standard output
+  std::ostringstream sink;
+  std::streambuf *cout_buf = std::cout.rdbuf(sink.rdbuf());
+  bool ok = true;
+  for (unsigned int seed = 0; seed < 300; seed++)
+    ok = check(seed) && ok;
+  std::cout.rdbuf(cout_buf);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
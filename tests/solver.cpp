@@ -0,0 +1,101 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/solver.hh>
+#include "brute.hh"
+
+/**
+ * \file Built-in solver on small random problems.
+ *
+ * The solver must find a solution exactly when the problem has one, and the
+ * install state it gives to the packages not marked keep must be a solution.
+ */
+
+namespace {
+  /// Checks the solver on the problem generated from \a seed
+  bool check(unsigned int seed, unsigned int& sat) {
+    BruteProblem orig;
+    randomProblem(orig, seed);
+    bool satisfiable = false;
+    orig.solutions([&](const installed_t&) { satisfiable = true; });
+
+    KCudfSolver sv;
+    randomProblem(sv, seed);
+    KCudfSolver::SOLVE_OUT out = sv.solve();
+    if (out == KCudfSolver::SO_UNKNOWN) {
+      std::cerr << "seed " << seed << ": the solver gave up" << std::endl;
+      return false;
+    }
+    if ((out == KCudfSolver::SO_SAT) != satisfiable) {
+      std::cerr << "seed " << seed << ": the problem is "
+                << (satisfiable ? "" : "not ") << "satisfiable, the solver "
+                << "says the opposite" << std::endl;
+      return false;
+    }
+    if (out == KCudfSolver::SO_UNSAT)
+      return true;
+    sat++;
+    // the kept packages keep the state of the problem
+    BruteProblem sol;
+    sv.solution(sol, "");
+    installed_t s = orig.installed();
+    for (unsigned int p : sol.ids())
+      if (sol.installed().count(p) > 0)
+        s.insert(p);
+      else
+        s.erase(p);
+    if (!orig.solution(s)) {
+      std::cerr << "seed " << seed << ": the solver returned a state that "
+                << "is not a solution" << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(void) {
+  bool ok = true;
+  unsigned int sat = 0;
+  for (unsigned int seed = 0; seed < 1000; seed++)
+    ok = check(seed, sat) && ok;
+  if (sat == 0 || sat == 1000) {
+    std::cerr << "the problems are all " << (sat == 0 ? "un" : "")
+              << "satisfiable" << std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/symmetry.hh>
+#include "brute.hh"
+
+/**
+ * \file Symmetry breaking on small random problems.
+ *
+ * The problem with the symmetry-breaking constraints must be satisfiable
+ * exactly when the original one is, with the same optimum (the least number
+ * of changes), and its solutions are solutions of the original problem. On
+ * odd seeds the odd packages are excluded and must not be constrained.
+ */
+
+namespace {
+  /// Problem recording the packages of the symmetry-breaking constraints
+  class SymProblem : public BruteProblem {
+  public:
+    /// Packages of the symmetry-breaking constraints
+    std::set<unsigned int> constrained;
+    void dependency(unsigned int p, unsigned int q, const char* desc) {
+      BruteProblem::dependency(p, q, desc);
+      if (std::string(desc) == "SYM") {
+        constrained.insert(p);
+        constrained.insert(q);
+      }
+    }
+  };
+
+  /// Least number of changes of the solutions of \a p, or ~0u if there is none
+  unsigned int optimum(const BruteProblem& p, bool& sound,
+                       const BruteProblem* orig = NULL) {
+    unsigned int best = ~0u;
+    p.solutions([&](const installed_t& s) {
+        best = std::min(best, p.changes(s));
+        sound = sound && (orig == NULL || orig->solution(s));
+      });
+    return best;
+  }
+
+  /// Checks the symmetry breaking of the problem generated from \a seed
+  bool check(unsigned int seed, unsigned int& classes) {
+    BruteProblem orig;
+    SymProblem sym;
+    randomProblem(orig, seed);
+    const bool excluded = seed % 2 == 1;
+    {
+      KCudfSymmetryWriter sw(sym);
+      if (excluded)
+        for (unsigned int p : orig.ids())
+          if (p % 2 == 1) sw.exclude(p);
+      randomProblem(sw, seed);
+      sw.flush();
+      classes += sw.classes();
+    }
+    for (unsigned int p : sym.constrained)
+      if (excluded && p % 2 == 1) {
+        std::cerr << "seed " << seed << ": excluded package " << p
+                  << " is constrained" << std::endl;
+        return false;
+      }
+    bool sound = true;
+    unsigned int o = optimum(orig, sound), s = optimum(sym, sound, &orig);
+    if ((o == ~0u) != (s == ~0u))
+      std::cerr << "seed " << seed << ": the original problem is "
+                << (o != ~0u ? "" : "not ") << "satisfiable, the one with "
+                << "symmetry breaking is " << (s != ~0u ? "" : "not ")
+                << "satisfiable" << std::endl;
+    else if (o != s)
+      std::cerr << "seed " << seed << ": the optimum changes from " << o
+                << " to " << s << " with symmetry breaking" << std::endl;
+    if (!sound)
+      std::cerr << "seed " << seed << ": a solution with symmetry breaking "
+                << "is not an original solution" << std::endl;
+    return o == s && sound;
+  }
+}
+
+int main(void) {
+  bool ok = true;
+  unsigned int classes = 0;
+  for (unsigned int seed = 0; seed < 1000; seed++)
+    ok = check(seed, classes) && ok;
+  if (classes == 0) {
+    std::cerr << "no interchangeable packages were found" << std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
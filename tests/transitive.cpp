@@ -0,0 +1,137 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <kcudf/reduce.hh>
+#include "brute.hh"
+
+/**
+ * \file Transitive reduction of the search dependencies on random problems.
+ *
+ * The reduction can only leave dependencies out of the search part: the
+ * solved part and the other records stay the same, and the dependencies
+ * that are kept must have the same transitive closure as all of them.
+ */
+
+namespace {
+  /// Dependencies of every package
+  typedef std::map<unsigned int, std::set<unsigned int> > deps_t;
+
+  /// Splits \a search into its dependencies \a deps and its other lines
+  std::vector<std::string> split(const std::string& search, deps_t& deps) {
+    std::vector<std::string> others;
+    std::istringstream is(search);
+    std::string l;
+    while (std::getline(is, l)) {
+      unsigned int p, q;
+      std::istringstream ls(l);
+      char c;
+      if (ls >> c && c == 'D' && ls >> p >> q)
+        deps[p].insert(q);
+      else
+        others.push_back(l);
+    }
+    std::sort(others.begin(), others.end());
+    return others;
+  }
+
+  /// Packages reachable from \a p through \a deps
+  std::set<unsigned int> reach(const deps_t& deps, unsigned int p) {
+    std::set<unsigned int> r;
+    std::vector<unsigned int> todo(1, p);
+    while (!todo.empty()) {
+      unsigned int q = todo.back();
+      todo.pop_back();
+      auto d = deps.find(q);
+      if (d == deps.end()) continue;
+      for (unsigned int n : d->second)
+        if (r.insert(n).second)
+          todo.push_back(n);
+    }
+    return r;
+  }
+
+  /// Checks the transitive reduction of the problem generated from \a seed
+  bool check(unsigned int seed, unsigned long& trimmed) {
+    std::ostringstream os;
+    {
+      KCudfFileWriter wrt(os);
+      randomProblem(wrt, seed, 10 + seed % 30);
+    }
+    std::string solved, search, tsolved, tsearch;
+    reduceText(os.str(), [](KCudfReducer&) {}, solved, search);
+    ReducerStats st;
+    reduceText(os.str(), [](KCudfReducer& r) { r.transitiveReduction(true); },
+               tsolved, tsearch, &st);
+    trimmed += st.deps_trimmed;
+    deps_t all, kept;
+    if (solved != tsolved || split(search, all) != split(tsearch, kept)) {
+      std::cerr << "seed " << seed << ": the reduction changes more than "
+                << "the dependencies" << std::endl;
+      return false;
+    }
+    for (auto& d : kept)
+      for (unsigned int q : d.second)
+        if (all[d.first].count(q) == 0) {
+          std::cerr << "seed " << seed << ": the reduction adds dependency "
+                    << d.first << " -> " << q << std::endl;
+          return false;
+        }
+    for (auto& d : all)
+      if (reach(all, d.first) != reach(kept, d.first)) {
+        std::cerr << "seed " << seed << ": the reduction changes the "
+                  << "packages reachable from " << d.first << std::endl;
+        return false;
+      }
+    return true;
+  }
+}
+
+int main(void) {
+  // the reducer reports its progress on the standard output
+  std::ostringstream sink;
+  std::streambuf *cout_buf = std::cout.rdbuf(sink.rdbuf());
+  bool ok = true;
+  unsigned long trimmed = 0;
+  for (unsigned int seed = 0; seed < 300; seed++)
+    ok = check(seed, trimmed) && ok;
+  std::cout.rdbuf(cout_buf);
+  if (trimmed == 0) {
+    std::cerr << "no dependency was left out" << std::endl;
+    ok = false;
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+#include <cstdlib>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <kcudf/zstream.hh>
+
+/**
+ * \file Round trip of the compressed streams.
+ *
+ * Every available format is written and read back with inputs of several
+ * sizes: empty, a single line, and enough lines to span several chunks with
+ * flushes in between. The first argument is the directory for the files.
+ */
+
+namespace {
+  /// Content with \a n lines
+  std::string content(unsigned int n) {
+    std::ostringstream os;
+    for (unsigned int i = 0; i < n; i++)
+      os << "P " << i << " K # package-" << i * 7919 << std::endl;
+    return os.str();
+  }
+
+  /// Writes \a s to \a fname in format \a c and reads it back
+  bool roundTrip(const std::string& fname, COMPRESSION c, const std::string& s) {
+    {
+      OutputFile os(fname.c_str(), c);
+      // flush every 64KB to exercise the reuse of the chunks
+      for (size_t i = 0; i < s.size(); i += 1 << 16) {
+        os.write(s.data() + i, std::min(s.size() - i, size_t(1) << 16));
+        os.flush();
+      }
+      os.close();
+      if (!os) {
+        std::cerr << fname << ": write failed" << std::endl;
+        return false;
+      }
+    }
+    std::string r;
+    try {
+      InputFile is(fname.c_str());
+      if (!is || is.compression() != c) {
+        std::cerr << fname << ": cannot be read back" << std::endl;
+        return false;
+      }
+      char b[4096];
+      while (is.read(b, sizeof(b)) || is.gcount() > 0)
+        r.append(b, is.gcount());
+    } catch (std::ios_base::failure& e) {
+      std::cerr << fname << ": " << e.what() << std::endl;
+      return false;
+    }
+    std::remove(fname.c_str());
+    if (r != s) {
+      std::cerr << fname << ": read " << r.size() << " bytes instead of "
+                << s.size() << std::endl;
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string dir(argc > 1 ? argv[1] : ".");
+  const COMPRESSION formats[] = {CMP_NONE, CMP_GZIP, CMP_ZSTD};
+  const char* ext[] = {".txt", ".gz", ".zst"};
+  const unsigned int sizes[] = {0, 1, 100000};
+  bool ok = true;
+  for (unsigned int f = 0; f < 3; f++) {
+    if (!compressionAvailable(formats[f])) {
+      std::cerr << ext[f] << ": not available, skipped" << std::endl;
+      continue;
+    }
+    for (unsigned int n : sizes) {
+      std::ostringstream fname;
+      fname << dir << "/zstream-" << n << ext[f];
+      ok = roundTrip(fname.str(), formats[f], content(n)) && ok;
+    }
+  }
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#ifndef __ALLOC_COUNTER_HH__
+#define __ALLOC_COUNTER_HH__
+
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
+
+/**
+ * \file Replacement of the global allocation functions that counts the
+ * number of allocations done by the program and the heap bytes they use.
+ *
+ * The bytes are the usable sizes of the blocks reported by the C library, so
+ * they include the rounding done by the allocator but not its headers.
+ *
+ * \warning The replacements are definitions: this file must be included by
+ * exactly one translation unit of the executable.
+ */
+
+/// Number of allocations done so far
+static std::atomic<unsigned long long> alloc_count(0);
+
+/// Heap bytes in use
+static std::atomic<size_t> alloc_live(0);
+/// Maximum heap bytes in use so far
+static std::atomic<size_t> alloc_peak(0);
+
+/// Returns the number of allocations done so far
+static unsigned long long allocations(void) {
+  return alloc_count.load(std::memory_order_relaxed);
+}
+
+/// Returns the heap bytes allocated with new and not deleted yet
+static inline size_t heapInUse(void) {
+  return alloc_live.load(std::memory_order_relaxed);
+}
+
+/// Returns the maximum of \a heapInUse so far
+static inline size_t heapPeak(void) {
+  return alloc_peak.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t n) {
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  void *p = std::malloc(n == 0 ? 1 : n);
+  if (p == NULL) throw std::bad_alloc();
+  size_t live = alloc_live.fetch_add(malloc_usable_size(p),
+                                     std::memory_order_relaxed)
+    + malloc_usable_size(p);
+  size_t peak = alloc_peak.load(std::memory_order_relaxed);
+  while (live > peak &&
+         !alloc_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    ;
+  return p;
+}
+
+void* operator new[](std::size_t n) {
+  return operator new(n);
+}
+
+void operator delete(void* p) noexcept {
+  if (p != NULL)
+    alloc_live.fetch_sub(malloc_usable_size(p), std::memory_order_relaxed);
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  operator delete(p);
+}
+
+#endif
@@ -0,0 +1,699 @@
+/* -*- mode: C++; c-basic-offset: 2; indent-tabs-mode: nil -*- */
+/*
+ *  Main authors:
+ *     The kcudf contributors
+ *
+ *  Copyright:
+ *     The kcudf contributors, 2026
+ *
+ *  Last modified:
+ *     $Date$ by $Author$
+ *     $Revision$
+ *
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining
+ *  a copy of this software and associated documentation files (the
+ *  "Software"), to deal in the Software without restriction, including
+ *  without limitation the rights to use, copy, modify, merge, publish,
+ *  distribute, sublicense, and/or sell copies of the Software, and to
+ *  permit persons to whom the Software is furnished to do so, subject to
+ *  the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be
+ *  included in all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ *  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ *  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ *  NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ *  LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *  OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ *  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <boost/program_options.hpp>
+#include <kcudf/kcudf.hh>
+#include <kcudf/swriter.hh>
+#include <kcudf/reduce.hh>
+#include "cmd-options.hh"
+
+/**
+ * \file Daemon serving translation and reduction requests on a UNIX socket.
+ *
+ * The universe is parsed once at startup. Every request replaces its request
+ * stanza and the installed state of some packages (see \a CudfRequest), so it
+ * only pays for its own translation and reduction. Requests are blocks of
+ * lines ended by an empty line or by the end of the connection:
+ *
+ * \verbatim
+ install: a, b >= 2
+ remove: c
+ upgrade: d
+ installed: e = 1, f = 3
+ uninstalled: g = 2
+ timeout: 2.5
+ \endverbatim
+ *
+ * All the lines are optional. install, remove and upgrade have the syntax of
+ * the cudf request stanza, installed and uninstalled override the state of
+ * the universe for the listed package versions and timeout cancels the
+ * request after that number of seconds (see \a CancelToken). The reply is
+ *
+ * \verbatim
+ status: search
+ latency: queue 0.01 parse 0.02 translate 812.4 reduce 95.7 total 908.1
+ solved: 1200
+ ...
+ search: 80
+ ...
+ info: 1500
+ ...
+ \endverbatim
+ *
+ * followed by an empty line. status is one of solved, search, fail, cancelled
+ * or error (the last two with a message line and nothing else). solved,
+ * search and info give the number of lines that follow with the solved part,
+ * the search part (both in kcudf) and the info of the translation. Latencies
+ * are in milliseconds, queue is the time the connection waited for a worker.
+ *
+ * A block with the single line "stats" returns the metrics of all the
+ * requests served so far and "shutdown" stops the daemon once the open
+ * connections are closed; shutdown is only accepted from the user running
+ * the daemon. Every connection is served by one thread of the worker pool
+ * and can send several requests, it is closed when it stays idle longer
+ * than the idle timeout.
+ *
+ * The progress messages of the library are discarded, the daemon only logs
+ * its own messages on the standard error.
+ */
+
+using namespace boost::program_options;
+using namespace std;
+
+namespace {
+  typedef std::chrono::steady_clock clock;
+
+  /// Milliseconds between \a b and \a e
+  double msecs(clock::time_point b, clock::time_point e) {
+    return std::chrono::duration<double, std::milli>(e - b).count();
+  }
+
+  /// Settings of the translation and reduction of every request
+  struct Settings {
+    bool prune;
+    unsigned int solveBelow;
+    unsigned int probe;
+    WL_POLICY schedule;
+    /// Timeout of the requests without one (0: none)
+    double timeout;
+    /// Seconds a connection can stay idle (0: forever)
+    double idle;
+  };
+
+  /// Outcome of a request
+  enum STATUS { ST_SOLVED, ST_SEARCH, ST_FAIL, ST_CANCELLED, ST_ERROR, ST_NSTATUS };
+
+  const char* statusName(STATUS s) {
+    static const char* names[ST_NSTATUS] =
+      {"solved", "search", "fail", "cancelled", "error"};
+    return names[s];
+  }
+
+  /// Latencies of a request in milliseconds
+  struct Latency {
+    double queue, parse, translate, reduce, total;
+    Latency(void) : queue(0), parse(0), translate(0), reduce(0), total(0) {}
+  };
+
+  /// Metrics of all the requests served
+  class Metrics {
+  private:
+    std::mutex mtx;
+    unsigned long count[ST_NSTATUS];
+    Latency sum;
+    double max;
+  public:
+    Metrics(void) : max(0) {
+      std::fill(count, count + ST_NSTATUS, 0);
+    }
+    void add(STATUS s, const Latency& l) {
+      std::lock_guard<std::mutex> lk(mtx);
+      count[s]++;
+      sum.queue += l.queue;
+      sum.parse += l.parse;
+      sum.translate += l.translate;
+      sum.reduce += l.reduce;
+      sum.total += l.total;
+      max = std::max(max, l.total);
+    }
+    void write(std::ostream& os) {
+      std::lock_guard<std::mutex> lk(mtx);
+      unsigned long n = 0;
+      for (unsigned int s = 0; s < ST_NSTATUS; s++)
+        n += count[s];
+      os << "requests: " << n << "\n";
+      for (unsigned int s = 0; s < ST_NSTATUS; s++)
+        os << statusName(static_cast<STATUS>(s)) << ": " << count[s] << "\n";
+      const double d = n > 0 ? n : 1;
+      os << "latency mean: queue " << sum.queue / d << " parse " << sum.parse / d
+         << " translate " << sum.translate / d << " reduce " << sum.reduce / d
+         << " total " << sum.total / d << "\n"
+         << "latency max: " << max << "\n";
+    }
+  };
+
+  /// Connections accepted and waiting for a worker
+  class ConnectionQueue {
+  private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::pair<int, clock::time_point> > q;
+    bool closed;
+  public:
+    ConnectionQueue(void) : closed(false) {}
+    void push(int fd) {
+      std::lock_guard<std::mutex> lk(mtx);
+      q.push_back(std::make_pair(fd, clock::now()));
+      cv.notify_one();
+    }
+    /// Returns false when the queue is closed and empty
+    bool pop(int& fd, clock::time_point& t) {
+      std::unique_lock<std::mutex> lk(mtx);
+      cv.wait(lk, [this](void) { return closed || !q.empty(); });
+      if (q.empty())
+        return false;
+      fd = q.front().first;
+      t = q.front().second;
+      q.pop_front();
+      return true;
+    }
+    void close(void) {
+      std::lock_guard<std::mutex> lk(mtx);
+      closed = true;
+      cv.notify_all();
+    }
+  };
+
+  /// Reads lines from a socket
+  class LineReader {
+  private:
+    int fd;
+    std::string buf;
+    size_t pos;
+    /// Whether the last read timed out (see \a Settings::idle)
+    bool idle;
+  public:
+    LineReader(int f) : fd(f), pos(0), idle(false) {}
+    /// Whether the connection was idle for too long
+    bool timedOut(void) const {
+      return idle;
+    }
+    /// Returns false at the end of the connection or when it times out
+    bool getline(std::string& line) {
+      for (;;) {
+        size_t nl = buf.find('\n', pos);
+        if (nl != std::string::npos) {
+          line.assign(buf, pos, nl - pos);
+          pos = nl + 1;
+          if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+          return true;
+        }
+        buf.erase(0, pos);
+        pos = 0;
+        char chunk[4096];
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n < 0 && errno == EINTR)
+          continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          idle = true;
+          return false;
+        }
+        if (n <= 0) {
+          // a last line without newline
+          if (buf.empty())
+            return false;
+          line.swap(buf);
+          buf.clear();
+          return true;
+        }
+        buf.append(chunk, n);
+      }
+    }
+  };
+
+  /// Writes all of \a s on socket \a fd
+  bool sendAll(int fd, const std::string& s) {
+    size_t off = 0;
+    while (off < s.size()) {
+      ssize_t n = send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n <= 0)
+        return false;
+      off += n;
+    }
+    return true;
+  }
+
+  /// Returns \a s without the surrounding blanks
+  std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos)
+      return "";
+    return s.substr(b, s.find_last_not_of(" \t") - b + 1);
+  }
+
+  /// Number of lines of \a s
+  size_t countLines(const std::string& s) {
+    return std::count(s.begin(), s.end(), '\n');
+  }
+
+  /// Stream buffer discarding everything written to it
+  class NullBuf : public std::streambuf {
+  protected:
+    int overflow(int c) {
+      return traits_type::not_eof(c);
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) {
+      return n;
+    }
+  };
+
+  /// Whether the peer of connection \a fd runs as the user of the daemon
+  bool sameUser(int fd) {
+    ucred cr;
+    socklen_t len = sizeof(cr);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cr, &len) == 0 &&
+      cr.uid == geteuid();
+  }
+
+  /// The daemon
+  class Daemon {
+  private:
+    /// The universe, never modified after loading
+    const CudfDoc& doc;
+    /// Package versions of the universe
+    std::set<std::pair<std::string,int> > versions;
+    /// Package versions of the universe with keep version
+    std::set<std::pair<std::string,int> > keepVersion;
+    /// The cudf parser is not reentrant
+    static std::mutex parser;
+    const Settings& cfg;
+    /// Log of the daemon (the standard streams are silenced)
+    std::ostream& log;
+    Metrics metrics;
+    ConnectionQueue queue;
+    /// Listening socket
+    int lfd;
+    /// Whether a shutdown was requested
+    std::atomic<bool> stopping;
+    /**
+     * \brief Parses the lines of a request in \a rq and \a timeout, returns
+     * an error message or an empty string.
+     */
+    std::string parseRequest(const std::vector<std::string>& lines,
+                             CudfRequest& rq, double& timeout) const;
+    /// Serves request \a lines and returns the reply
+    std::string solve(const std::vector<std::string>& lines, Latency& l);
+    /// Serves all the requests of connection \a fd
+    void serve(int fd, clock::time_point accepted);
+    /// Body of the worker threads
+    void work(void);
+  public:
+    Daemon(const CudfDoc& d, const Settings& s, std::ostream& l);
+    /// Accepts connections on \a path with \a threads workers until shutdown
+    int run(const char* path, unsigned int threads);
+  };
+
+  std::mutex Daemon::parser;
+
+  Daemon::Daemon(const CudfDoc& d, const Settings& s, std::ostream& l)
+    : doc(d), cfg(s), log(l), lfd(-1), stopping(false) {
+    for (const CudfPackage& pi : doc.getPackages()) {
+      versions.insert(std::make_pair(pi.name(), pi.version()));
+      if (pi.keep() == KP_VERSION)
+        keepVersion.insert(std::make_pair(pi.name(), pi.version()));
+    }
+  }
+
+  std::string Daemon::parseRequest(const std::vector<std::string>& lines,
+                                   CudfRequest& rq, double& timeout) const {
+    std::ostringstream stanza;
+    bool constraints = false;
+    for (const std::string& ln : lines) {
+      size_t c = ln.find(':');
+      if (c == std::string::npos)
+        return "malformed line '" + ln + "'";
+      const std::string key = trim(ln.substr(0, c));
+      const std::string val = trim(ln.substr(c + 1));
+      if (key == "install" || key == "remove" || key == "upgrade") {
+        stanza << key << ": " << val << "\n";
+        constraints = true;
+      } else if (key == "installed" || key == "uninstalled") {
+        std::istringstream is(val);
+        std::string item;
+        while (std::getline(is, item, ',')) {
+          size_t eq = item.find('=');
+          if (eq == std::string::npos)
+            return "expected name = version in '" + trim(item) + "'";
+          const std::string name = trim(item.substr(0, eq));
+          int v = std::atoi(trim(item.substr(eq + 1)).c_str());
+          std::pair<std::string,int> pv(name, v);
+          if (versions.count(pv) == 0)
+            return "unknown package '" + trim(item) + "'";
+          if (key == "uninstalled" && keepVersion.count(pv) > 0)
+            return "package '" + trim(item) + "' keeps its version, it cannot be uninstalled";
+          rq.installed[pv] = key == "installed";
+        }
+      } else if (key == "timeout") {
+        timeout = std::atof(val.c_str());
+      } else
+        return "unknown property '" + key + "'";
+    }
+    if (constraints) {
+      std::istringstream is("request: kcudfd\n" + stanza.str());
+      std::lock_guard<std::mutex> lk(parser);
+      parse(is, rq.request);
+    }
+    return "";
+  }
+
+  std::string Daemon::solve(const std::vector<std::string>& lines, Latency& l) {
+    std::ostringstream reply;
+    STATUS status = ST_ERROR;
+    std::string message, kcudf, info, solved, search;
+    // ends of the parsing, translation and reduction
+    const clock::time_point t0 = clock::now();
+    clock::time_point t1 = t0, t2 = t0, t3 = t0;
+    // end of the phase running, it is set when the phase throws
+    clock::time_point* running = &t1;
+    try {
+      CudfRequest rq;
+      double timeout = cfg.timeout;
+      message = parseRequest(lines, rq, timeout);
+      t1 = clock::now();
+      running = &t2;
+      if (message.empty()) {
+        CancelToken token;
+        if (timeout > 0)
+          token.deadline(timeout);
+        {
+          KCudfTranslator tr(doc, false, cfg.prune, &token, &rq);
+          std::ostringstream ko, io;
+          {
+            KCudfFileWriter kw(ko);
+            KCudfInfoFileWriter iw(io);
+            tr.translate(kw, iw, false);
+          }
+          kcudf = ko.str();
+          info = io.str();
+        }
+        t2 = clock::now();
+        running = &t3;
+        // reading the translation cannot be cancelled
+        if (token.expired())
+          throw KCudfCancelled("reduction deadline expired");
+        KCudfReducer red;
+        red.solverThreshold(cfg.solveBelow);
+        red.probing(cfg.probe);
+        red.scheduling(cfg.schedule);
+        red.cancellation(&token);
+        {
+          std::istringstream ki(kcudf);
+          read(ki, red);
+        }
+        std::ostringstream so, sr;
+        KCudfReducer::RD_OUT r;
+        {
+          KCudfFileWriter sw(so);
+          KCudfFileWriter rw(sr);
+          r = red.reduce(sw, rw);
+        }
+        t3 = clock::now();
+        switch (r) {
+        case KCudfReducer::RDO_SOL: status = ST_SOLVED; break;
+        case KCudfReducer::RDO_SEARCH: status = ST_SEARCH; break;
+        case KCudfReducer::RDO_FAIL:
+          status = ST_FAIL;
+          message = trim(red.stats().failure);
+          break;
+        case KCudfReducer::RDO_CANCEL:
+          status = ST_CANCELLED;
+          message = "reduction deadline expired";
+          break;
+        }
+        solved = so.str();
+        search = sr.str();
+      }
+      running = NULL;
+    } catch (KCudfCancelled& c) {
+      status = ST_CANCELLED;
+      message = c.what();
+    } catch (KCudfFailedRequest& f) {
+      status = ST_FAIL;
+      message = trim(f.what());
+    } catch (std::exception& e) {
+      status = ST_ERROR;
+      message = e.what();
+    }
+    const clock::time_point t4 = clock::now();
+    if (running != NULL)
+      *running = t4;
+    t2 = std::max(t1, t2);
+    t3 = std::max(t2, t3);
+    l.parse = msecs(t0, t1);
+    l.translate = msecs(t1, t2);
+    l.reduce = msecs(t2, t3);
+    l.total += msecs(t0, t4);
+    metrics.add(status, l);
+
+    reply << "status: " << statusName(status) << "\n";
+    if (!message.empty())
+      reply << "message: " << message << "\n";
+    reply << "latency: queue " << l.queue << " parse " << l.parse
+          << " translate " << l.translate << " reduce " << l.reduce
+          << " total " << l.total << "\n";
+    if (status == ST_SOLVED || status == ST_SEARCH || status == ST_FAIL) {
+      reply << "solved: " << countLines(solved) << "\n" << solved
+            << "search: " << countLines(search) << "\n" << search
+            << "info: " << countLines(info) << "\n" << info;
+    }
+    reply << "\n";
+    return reply.str();
+  }
+
+  void Daemon::serve(int fd, clock::time_point accepted) {
+    LineReader rd(fd);
+    std::vector<std::string> req;
+    std::string line;
+    double queue = msecs(accepted, clock::now());
+    bool more = true;
+    while (more) {
+      more = rd.getline(line);
+      if (more && !trim(line).empty()) {
+        req.push_back(line);
+        continue;
+      }
+      // a request cut by the idle timeout is not served
+      if (req.empty() || rd.timedOut())
+        continue;
+      std::string reply;
+      if (req.size() == 1 && trim(req[0]) == "stats") {
+        std::ostringstream os;
+        metrics.write(os);
+        os << "\n";
+        reply = os.str();
+      } else if (req.size() == 1 && trim(req[0]) == "shutdown") {
+        if (sameUser(fd)) {
+          stopping = true;
+          ::shutdown(lfd, SHUT_RDWR);
+          reply = "status: shutdown\n\n";
+        } else
+          reply = "status: error\nmessage: shutdown is only accepted from the "
+            "user running the daemon\n\n";
+      } else {
+        Latency l;
+        // only the first request of a connection waits for a worker
+        l.queue = queue;
+        l.total = queue;
+        queue = 0;
+        reply = solve(req, l);
+      }
+      req.clear();
+      if (!sendAll(fd, reply))
+        break;
+    }
+    close(fd);
+  }
+
+  void Daemon::work(void) {
+    int fd;
+    clock::time_point t;
+    while (queue.pop(fd, t))
+      serve(fd, t);
+  }
+
+  int Daemon::run(const char* path, unsigned int threads) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (std::strlen(path) >= sizeof(addr.sun_path)) {
+      log << "error: socket path '" << path << "' is too long" << endl;
+      return EXIT_FAILURE;
+    }
+    std::strcpy(addr.sun_path, path);
+    // only a stale socket is replaced
+    struct stat sb;
+    if (lstat(path, &sb) == 0) {
+      if (!S_ISSOCK(sb.st_mode)) {
+        log << "error: '" << path << "' exists and is not a socket" << endl;
+        return EXIT_FAILURE;
+      }
+      unlink(path);
+    }
+    lfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (lfd < 0 || bind(lfd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0
+        || listen(lfd, 64) < 0) {
+      log << "error: cannot listen on '" << path << "': " << strerror(errno) << endl;
+      return EXIT_FAILURE;
+    }
+    log << "Listening on " << path << " with " << threads << " workers" << endl;
+
+    std::vector<std::thread> workers;
+    for (unsigned int i = 0; i < threads; i++)
+      workers.push_back(std::thread(&Daemon::work, this));
+    while (!stopping) {
+      int fd = accept(lfd, NULL, NULL);
+      if (fd < 0) {
+        if (errno == EINTR || errno == ECONNABORTED)
+          continue;
+        if (!stopping)
+          log << "error: accept failed: " << strerror(errno) << endl;
+        break;
+      }
+      if (cfg.idle > 0) {
+        // stalled peers are dropped instead of holding a worker
+        timeval tv;
+        tv.tv_sec = static_cast<time_t>(cfg.idle);
+        tv.tv_usec = static_cast<suseconds_t>((cfg.idle - tv.tv_sec) * 1e6);
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+      }
+      queue.push(fd);
+    }
+    queue.close();
+    for (std::thread& w : workers)
+      w.join();
+    close(lfd);
+    unlink(path);
+    return EXIT_SUCCESS;
+  }
+}
+
+void parseCmdOptions(variables_map& vm, int argc, char* argv[]) {
+  options_description general("Available options");
+
+  general.add_options()
+    ("cudf", value<std::string>(),
+     "File containing the cudf universe, its request is ignored.\n")
+    ("socket", value<std::string>()->default_value("kcudfd.sock"),
+     "Path of the UNIX socket to listen on.\n")
+    ("threads", value<unsigned int>()->default_value(0),
+     "Number of worker threads (0: one per hardware thread).\n")
+    ("prune", bool_switch(),
+     "Translate only the cone of influence of the installed packages and the request.\n")
+    ("solve-below", value<unsigned int>()->default_value(0),
+     "Solve search parts up to this number of packages with the built-in solver (0 disables it).\n")
+    ("probe", value<unsigned int>()->default_value(0),
+     "Probe the packages left for the search with this number of threads (0 disables it).\n")
+    ("schedule", value<std::string>()->default_value("fifo"),
+     "Scheduling policy of the reducer can operations: fifo, lifo, degree or bucket.\n")
+    ("timeout", value<double>()->default_value(0),
+     "Cancel the requests that do not set a timeout after this number of seconds (0: never).\n")
+    ("idle", value<double>()->default_value(60),
+     "Close the connections idle for this number of seconds (0: never).\n")
+    ("help", "print this message");
+
+  positional_options_description pd;
+  pd.add("cudf",1).add("socket",1);
+
+  store(command_line_parser(argc, argv).options(general).positional(pd).run(), vm);
+  notify(vm);
+
+  if (vm.count("help")) {
+    cout << endl << "Example calls:" << endl
+         << argv[0] << " universe.cudf /tmp/kcudfd.sock" << endl
+         << argv[0] << " --cudf universe.cudf --socket /tmp/kcudfd.sock --threads 4" << endl
+         << endl << endl << general << endl;
+    exit(EXIT_SUCCESS);
+  }
+}
+
+int main(int argc, char **argv) {
+  variables_map vm;
+  parseCmdOptions(vm,argc,argv);
+  mandatory_option(vm,"cudf");
+
+  Settings cfg;
+  cfg.prune = vm["prune"].as<bool>();
+  cfg.solveBelow = vm["solve-below"].as<unsigned int>();
+  cfg.probe = vm["probe"].as<unsigned int>();
+  cfg.timeout = vm["timeout"].as<double>();
+  cfg.idle = vm["idle"].as<double>();
+  if (!policyFromName(vm["schedule"].as<std::string>(), cfg.schedule)) {
+    cerr << "error: unknown scheduling policy '"
+         << vm["schedule"].as<std::string>() << "'" << endl;
+    return EXIT_FAILURE;
+  }
+  unsigned int threads = vm["threads"].as<unsigned int>();
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  const char* input = vm["cudf"].as<std::string>().c_str();
+  InputFile cudf_st(input);
+  if (!cudf_st) {
+    cerr << "error: file '" << input << "' not found" << endl;
+    return EXIT_FAILURE;
+  }
+  // the library reports its progress on the standard streams
+  NullBuf null;
+  std::streambuf *cout_buf = std::cout.rdbuf(&null);
+  std::streambuf *cerr_buf = std::cerr.rdbuf(&null);
+  std::ostream log(cerr_buf);
+
+  CudfDoc doc;
+  clock::time_point t = clock::now();
+  parse(cudf_st,doc);
+  log << "Loaded " << doc.getPackages().size() << " packages from " << input
+      << " in " << msecs(t, clock::now()) << " ms" << endl;
+
+  int r;
+  {
+    Daemon d(doc, cfg, log);
+    r = d.run(vm["socket"].as<std::string>().c_str(), threads);
+  }
+  std::cout.rdbuf(cout_buf);
+  std::cerr.rdbuf(cerr_buf);
+  return r;
+}
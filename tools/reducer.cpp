@@ -34,13 +34,21 @@
  *
  */
 
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <boost/program_options.hpp>
 #include "cmd-options.hh"
+#include "alloc-counter.hh"
 #include <kcudf/reduce.hh>
 #include <kcudf/swriter.hh>
 #include <kcudf/gwriter.hh>
+#include <kcudf/renumber.hh>
+#include <kcudf/merge.hh>
+#include <kcudf/collapse.hh>
+#include <kcudf/symmetry.hh>
+#include <kcudf/satwriter.hh>
 
 using namespace boost::program_options;
 
@@ -54,12 +62,42 @@ void parseCmdOptions(variables_map& vm, int argc, char* argv[]) {
      "File containing the kcudf description.\n")
     ("solved", value<std::string>(),
      "Solved kcudf (only contains package information).\n")
+    ("compact", bool_switch(),
+     "Write the solved part in the compact run-length encoding.\n")
     ("search", value<std::string>(),
      "Resulting kcudf with the problem instance.\n")
+    ("solve-below", value<unsigned int>()->default_value(0),
+     "Solve search parts up to this number of packages with the built-in solver (0 disables it).\n")
+    ("probe", value<unsigned int>()->default_value(0),
+     "Probe the packages left for the search with this number of threads (0 disables it).\n")
+    ("schedule", value<std::string>()->default_value("fifo"),
+     "Scheduling policy of the reducer can operations: fifo, lifo, degree or bucket.\n")
+    ("timeout", value<double>(),
+     "Stop the reduction after this number of seconds, nothing but the statistics and the trace is written then and the exit status is non-zero.\n")
+    ("transitive-reduction", bool_switch(),
+     "Leave out of the search part the dependencies implied by other ones.\n")
+    ("format", value<std::string>()->default_value("kcudf"),
+     "Format of the search part: kcudf, cnf (DIMACS) or opb.\n")
+    ("varmap", value<std::string>(),
+     "Variable map of the cnf and opb formats (default: search file with .vars appended).\n")
+    ("collapse", value<std::string>(),
+     "Collapse the dependency cycles before reducing and write the components to this file (see KCudfExpandWriter)\n")
+    ("merge", value<std::string>(),
+     "Merge equivalent packages of the search part and write the classes to this file (see KCudfExpandWriter)\n")
+    ("break-symmetries", bool_switch(),
+     "Add constraints to the search part that rule out the symmetric assignments of interchangeable packages\n")
+    ("renumber", value<std::string>(),
+     "Emit consecutive identifiers in the search part and write the table to translate them back to this file\n")
     ("paranoid", value<std::string>(),
      "file to read paranoid data from\n")
     ("dumpdb", value<std::string>(),
      "File that will contain the database commands")
+    ("memory", bool_switch(),
+     "Print an estimate of the memory used by the reducer data structures and the heap counted by the allocator.\n")
+    ("trace", value<std::string>(),
+     "File to output a timeline of the reduction (chrome trace event format)")
+    ("stats-json", value<std::string>(),
+     "File to output the reduction statistics and profile in json")
     ("help", "print this message");
 
   positional_options_description pd;
@@ -102,7 +140,7 @@ int main(int argc, char **argv) {
   mandatory_option(vm,"search");
 
   const char* kcudf = vm["kcudf"].as<std::string>().c_str();
-  ifstream kcudf_st(kcudf);
+  InputFile kcudf_st(kcudf);
   if (!kcudf_st) {
     cerr << "error: file '" << kcudf << "' not found" << endl;
     return EXIT_FAILURE;
@@ -114,7 +152,7 @@ int main(int argc, char **argv) {
 
   KCudfReducer* red;
   if (optionEnabled(vm,"paranoid")) {
-    std::ifstream is(vm["paranoid"].as<std::string>().c_str());
+    InputFile is(vm["paranoid"].as<std::string>().c_str());
     if (!is) {
       cerr << "Cannot open file with paranoid information" << endl;
     }
@@ -123,20 +161,159 @@ int main(int argc, char **argv) {
     red = new KCudfReducer;
   }
 
+  if (optionEnabled(vm,"trace")) {
+#ifndef KCUDF_TRACE
+    cerr << "warning: trace events are not compiled in (cmake -DENABLE_TRACE=ON)" << endl;
+#endif
+    Trace::start();
+  }
+
+  red->solverThreshold(vm["solve-below"].as<unsigned int>());
+  red->probing(vm["probe"].as<unsigned int>());
+  red->transitiveReduction(vm["transitive-reduction"].as<bool>());
+  WL_POLICY pol;
+  if (!policyFromName(vm["schedule"].as<std::string>(), pol)) {
+    cerr << "error: unknown scheduling policy '"
+         << vm["schedule"].as<std::string>() << "'" << endl;
+    return EXIT_FAILURE;
+  }
+  red->scheduling(pol);
+  CancelToken token;
+  if (optionEnabled(vm,"timeout"))
+    red->cancellation(&token);
+
+  if (optionEnabled(vm,"stats-json")) {
+    PhaseStats::allocations = allocations;
+    red->profile(true);
+  }
   
-  read(kcudf_st,*red);
-  KCudfFileWriter es(solved);
-  KCudfFileWriter sr(search);
+  KCudfMerging cl;
+  if (optionEnabled(vm,"collapse")) {
+    KCudfCollapseWriter cw(*red);
+    read(kcudf_st,cw);
+    cw.flush(cl);
+    red->collapsed(cl);
+    ofstream os(vm["collapse"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the collapsed packages cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    cl.write(os);
+    cerr << "Collapsed " << cl.merged() << " packages in dependency cycles into "
+         << cl.size() << " representatives" << endl;
+  } else
+    read(kcudf_st,*red);
+
+  MemoryReport mr(vm["memory"].as<bool>());
+  if (mr.enabled()) {
+    MemoryReport::heapInUse = heapInUse;
+    MemoryReport::heapPeak = heapPeak;
+    mr.begin();
+    red->memory(mr);
+    mr.end();
+  }
+
+  std::unique_ptr<KCudfWriter> es;
+  KCudfSolvedWriter* compact = NULL;
+  if (vm["compact"].as<bool>())
+    es.reset(compact = new KCudfSolvedWriter(solved));
+  else
+    es.reset(new KCudfFileWriter(solved));
+  const std::string format = vm["format"].as<std::string>();
+  std::string varmap(search); varmap.append(".vars");
+  if (optionEnabled(vm,"varmap"))
+    varmap = vm["varmap"].as<std::string>();
+  std::unique_ptr<KCudfWriter> sr;
+  KCudfOpbWriter* opb = NULL;
+  if (format == "cnf")
+    sr.reset(new KCudfDimacsWriter(search, varmap.c_str()));
+  else if (format == "opb")
+    sr.reset(opb = new KCudfOpbWriter(search, varmap.c_str()));
+  else if (format == "kcudf")
+    sr.reset(new KCudfFileWriter(search));
+  else {
+    cerr << "error: unknown search format '" << format << "'" << endl;
+    return EXIT_FAILURE;
+  }
 
   cerr << "*** Reducing: " << kcudf << endl
        << "\tsolved:\t" << solved << endl
        << "\tsearch:\t" << search << endl;
 
-  KCudfReducer::RD_OUT rout = red->reduce(es,sr);
+  // search writers: merging, symmetry breaking, renumbering and output
+  KCudfRenumbering rn;
+  KCudfRenumberWriter<KCudfWriter> rsr(*sr,rn);
+  KCudfWriter& ren = optionEnabled(vm,"renumber") ?
+    static_cast<KCudfWriter&>(rsr) : *sr;
+  KCudfSymmetryWriter ssr(ren);
+  if (vm["break-symmetries"].as<bool>() && optionEnabled(vm,"paranoid")) {
+    // the paranoid criteria tell interchangeable packages apart
+    InputFile is(vm["paranoid"].as<std::string>().c_str());
+    unsigned int p;
+    while (is >> p)
+      ssr.exclude(p);
+  }
+  KCudfWriter& out = vm["break-symmetries"].as<bool>() ?
+    static_cast<KCudfWriter&>(ssr) : ren;
+  KCudfMerging mg;
+  KCudfMergeWriter msr(out);
+  // the solved part gets the members of the collapsed cycles back
+  KCudfExpandWriter<KCudfWriter> ees(*es,cl);
+  if (optionEnabled(vm,"timeout"))
+    token.deadline(vm["timeout"].as<double>());
+  KCudfReducer::RD_OUT rout = optionEnabled(vm,"merge") ?
+    red->reduce(ees,msr) : red->reduce(ees,out);
+  const bool cancelled = rout == KCudfReducer::RDO_CANCEL;
+  if (cancelled) {
+    // the writers leave headers behind, none of the outputs is kept
+    es.reset();
+    sr.reset();
+    std::remove(solved);
+    std::remove(search);
+    if (format != "kcudf")
+      std::remove(varmap.c_str());
+    if (optionEnabled(vm,"collapse"))
+      std::remove(vm["collapse"].as<std::string>().c_str());
+  }
+  if (optionEnabled(vm,"merge") && !cancelled) {
+    msr.flush(mg);
+    ofstream os(vm["merge"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the merged packages cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    mg.write(os);
+    cerr << "Merged " << mg.merged() << " equivalent packages into "
+         << mg.size() << " representatives" << endl;
+  }
+  if (vm["break-symmetries"].as<bool>() && !cancelled) {
+    unsigned int nc = ssr.flush();
+    cerr << "Added " << nc << " symmetry-breaking constraints on "
+         << ssr.classes() << " classes of interchangeable packages" << endl;
+  }
+  if (opb != NULL && optionEnabled(vm,"merge") && !cancelled) {
+    // the members of a class installed with its representative change with it
+    for (const KCudfMerging::Class& c : mg.classes())
+      if (c.all)
+        opb->weight(optionEnabled(vm,"renumber") ? rn.renumbered(c.rep) : c.rep,
+                    1 + c.members.size());
+  }
+
+  if (compact != NULL && !cancelled) {
+    try {
+      compact->close();
+    } catch (FailedStream& e) {
+      cerr << e.what() << endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   switch (rout) {
     case KCudfReducer::RDO_SOL:
-      cerr << "** The reducer has found a solution **" << endl;
+      if (red->stats().solver)
+        cerr << "** The built-in solver has found a solution **" << endl;
+      else
+        cerr << "** The reducer has found a solution **" << endl;
       break;
     case KCudfReducer::RDO_FAIL:
       cerr << "** No solution **" << endl;
@@ -144,13 +321,51 @@ int main(int argc, char **argv) {
     case KCudfReducer::RDO_SEARCH:
       cerr << "** NEED SERCH **" << endl;
       break;
+    case KCudfReducer::RDO_CANCEL:
+      cerr << "** CANCELLED **" << endl;
+      break;
+  }
+
+  if (mr.enabled()) {
+    mr.begin();
+    red->memory(mr);
+    mr.end();
+    cerr << mr << endl;
+  }
+
+  if (!cancelled)
+    cerr
+      << "The file " << solved
+      << " contains the solved part of the problem" << endl
+      << "The file " << search
+      << " contains the input for the solver" << endl;
+
+  if (optionEnabled(vm,"renumber") && !cancelled) {
+    ofstream os(vm["renumber"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the renumbering cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    rn.write(os);
+  }
+
+  if (optionEnabled(vm,"stats-json")) {
+    ofstream os(vm["stats-json"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the statistics cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    writeJson(os,red->stats());
   }
 
-  cerr 
-    << "The file " << solved
-    << " contains the solved part of the problem" << endl
-    << "The file " << search
-    << " contains the input for the solver" << endl;
+  if (optionEnabled(vm,"trace")) {
+    ofstream os(vm["trace"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the trace cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    Trace::write(os);
+  }
 
-  return EXIT_SUCCESS;
+  return cancelled ? EXIT_FAILURE : EXIT_SUCCESS;
 }
@@ -34,12 +34,17 @@
  *
  */
 
+#include <cstdio>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <boost/program_options.hpp>
 #include <kcudf/kcudf.hh>
 #include <kcudf/swriter.hh>
+#include <kcudf/infoindex.hh>
+#include <kcudf/renumber.hh>
 #include "cmd-options.hh"
+#include "alloc-counter.hh"
 
 using namespace boost::program_options;
 
@@ -52,11 +57,23 @@ void parseCmdOptions(variables_map& vm, int argc, char* argv[]) {
      ("kcudf", value<std::string>(),
       "File containing the resulting kernel cudf")
      ("info", value<std::string>(),
-      "File containing the info file")
+      "File containing the info file (an info index if it ends in .idx)")
+     ("renumber", value<std::string>(),
+      "Emit consecutive package identifiers and write the table to translate them back to this file")
      ("paranoid", value<std::string>(),
       "File to ouput paranoid related information")
      ("dumpdb", value<std::string>(),
       "File that will contain the database commands")
+     ("prune", bool_switch(),
+      "Translate only the cone of influence of the installed packages and the request.\n")
+     ("memory", bool_switch(),
+      "Print an estimate of the memory used by the translation data structures and the heap counted by the allocator.\n")
+     ("timeout", value<double>(),
+      "Stop the translation after this number of seconds.\n")
+     ("trace", value<std::string>(),
+      "File to output a timeline of the translation (chrome trace event format)")
+     ("stats-json", value<std::string>(),
+      "File to output the translation statistics (phase timings and counters) in json")
      ("debug", bool_switch(),"Include debug information, useful for the dotter but on big inputs it can be slow.\n")
      ("help", "print this message");
    
@@ -88,6 +105,7 @@ void writeStats(std::ostream& os, const TranslatorStats& st) {
     << "\tReal disjunctions: " << st.rd << std::endl
     << "\tEqual disj: " << st.ed << std::endl
     << "\tZero-provider disj: " << st.zp << std::endl
+    << "\tPruned packages: " << st.pruned << std::endl
     << std::endl;
 }
 
@@ -100,7 +118,7 @@ int main(int argc, char **argv) {
   mandatory_option(vm,"cudf");
 
   const char* input = vm["cudf"].as<std::string>().c_str();
-  ifstream cudf_st(input);
+  InputFile cudf_st(input);
   if (!cudf_st) {
     cerr << "error: file '" << input << "' not found" << endl;
     return EXIT_FAILURE;
@@ -114,25 +132,91 @@ int main(int argc, char **argv) {
   const char* info = (optionEnabled(vm, "info")) ?
     vm["info"].as<std::string>().c_str() : infoname.c_str();
 
-	CudfDoc doc;
-	parse(cudf_st,doc);
-  KCudfFileWriter out(kcudf);
-  KCudfInfoFileWriter inf(info);
+  if (optionEnabled(vm,"stats-json"))
+    PhaseStats::allocations = allocations;
+  if (vm["memory"].as<bool>()) {
+    MemoryReport::heapInUse = heapInUse;
+    MemoryReport::heapPeak = heapPeak;
+  }
 
+  if (optionEnabled(vm,"trace")) {
+#ifndef KCUDF_TRACE
+    cerr << "warning: trace events are not compiled in (cmake -DENABLE_TRACE=ON)" << endl;
+#endif
+    Trace::start();
+  }
 
-  KCudfTranslator tr(doc);
+	CudfDoc doc;
+  {
+    KCUDF_TRACE_SCOPE("parse");
+    parse(cudf_st,doc);
+  }
+  CancelToken token;
+  if (optionEnabled(vm,"timeout"))
+    token.deadline(vm["timeout"].as<double>());
+  std::unique_ptr<KCudfFileWriter> out;
+  std::unique_ptr<KCudfInfoWriter> inf;
+  // the index is written on close, NULL for a text info file
+  KCudfInfoIndexWriter* idx = NULL;
+  // a failed translation keeps no output, not even one of a previous run
+  auto discard = [&](void) {
+    out.reset();
+    inf.reset();
+    std::remove(kcudf);
+    std::remove(info);
+    for (const char* o : {"paranoid", "renumber"})
+      if (optionEnabled(vm,o))
+        std::remove(vm[o].as<std::string>().c_str());
+    exit(EXIT_FAILURE);
+  };
+  std::unique_ptr<KCudfTranslator> trp;
+  try {
+    trp.reset(new KCudfTranslator(doc,vm["memory"].as<bool>(),
+                                  vm["prune"].as<bool>(),&token,NULL,
+                                  optionEnabled(vm,"paranoid")));
+  } catch (KCudfFailure& f) {
+    std::cerr << f.what() << endl;
+    discard();
+  }
+  KCudfTranslator& tr = *trp;
+  KCudfRenumbering rn;
+
+  // the outputs are only created once the translator is built
+  out.reset(new KCudfFileWriter(kcudf));
+  std::string infos(info);
+  if (infos.size() > 4 && infos.compare(infos.size() - 4, 4, ".idx") == 0)
+    inf.reset(idx = new KCudfInfoIndexWriter(info));
+  else
+    inf.reset(new KCudfInfoFileWriter(info));
 
   try {
-    tr.translate(out,inf,vm["debug"].as<bool>());
+    if (optionEnabled(vm,"renumber")) {
+      KCudfRenumberWriter<KCudfFileWriter> rout(*out,rn);
+      KCudfRenumberInfoWriter<KCudfInfoWriter> rinf(*inf,rn);
+      tr.translate(rout,rinf,vm["debug"].as<bool>());
+    } else
+      tr.translate(*out,*inf,vm["debug"].as<bool>());
     //tm.stop();
   } catch (KCudfFailedRequest& fr) {
     std::cerr << fr.what();
   } catch (KCudfInvalidProvide& ip) {
     std::cerr << ip.what();
-    exit(EXIT_FAILURE);
+    discard();
+  } catch (KCudfCancelled& c) {
+    std::cerr << c.what() << endl;
+    discard();
   } catch (...) {
     std::cerr << "Unknown exception!" << endl;
-    exit(EXIT_FAILURE);
+    discard();
+  }
+
+  if (idx != NULL) {
+    try {
+      idx->close();
+    } catch (FailedStream& e) {
+      cerr << e.what() << endl;
+      discard();
+    }
   }
   
   if (optionEnabled(vm,"paranoid")) {
@@ -141,10 +225,27 @@ int main(int argc, char **argv) {
       cerr << "file to ouput extra information cannot be oppened" << endl;
       return EXIT_FAILURE;
     }
-    tr.writeParanoid(os);
+    if (optionEnabled(vm,"renumber")) {
+      std::vector<int> search;
+      tr.extraParanoid(search);
+      // packages that were not written have no new identifier
+      for (int i : search)
+        if (rn.renumbered(i) != KCudfRenumbering::NONE)
+          os << rn.renumbered(i) << std::endl;
+    } else
+      tr.writeParanoid(os);
     os.close();
   }
 
+  if (optionEnabled(vm,"renumber")) {
+    ofstream os(vm["renumber"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the renumbering cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    rn.write(os);
+  }
+
 //  if (optionEnabled(vm,"inst-concretes")) {
 //    ofstream os(vm["inst-concretes"].as<std::string>().c_str());
 //    if (!os) {
@@ -157,6 +258,26 @@ int main(int argc, char **argv) {
   
   
   writeStats(std::cerr,tr.stats());
+  if (tr.stats().memory.enabled())
+    std::cerr << tr.stats().memory << std::endl;
+
+  if (optionEnabled(vm,"stats-json")) {
+    ofstream os(vm["stats-json"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the statistics cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    writeJson(os,tr.stats());
+  }
+
+  if (optionEnabled(vm,"trace")) {
+    ofstream os(vm["trace"].as<std::string>().c_str());
+    if (!os) {
+      cerr << "file to ouput the trace cannot be oppened" << endl;
+      return EXIT_FAILURE;
+    }
+    Trace::write(os);
+  }
 
   std::cout << "Generated KCUDF file: " << kcudf << std::endl;
   std::cout << "Generated INFO file: " << info << std::endl;